@@ -0,0 +1,877 @@
+/*
+** benchmark.cpp
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <chloride.h>
+
+// Define shorthand aliases:	shorthand	long type			default parameters
+typedef Crypto::Operation	COp;
+template <COp O> using		COpTraits =	Crypto::OperationTraits<O>;
+template <COp O, std::size_t S = 						COpTraits<O>::NonceDefaultSequentialSize>
+		 using		CBoxOpener =	Crypto::BoxOpener<O, S>;
+template <COp O, std::size_t S = 						COpTraits<O>::NonceDefaultSequentialSize>
+		 using		CBoxSealer =	Crypto::BoxSealer<O, S>;
+template <COp O> using		CKeyPair =	Crypto::KeyPair<O>;
+template <COp O, std::size_t S = 						COpTraits<O>::NonceDefaultSequentialSize>
+		 using		CNonce =	Crypto::Nonce<O, S>;
+template <COp O> using 		CSecKey =	Crypto::SecretKey<O>;
+template <COp O, std::size_t S = 						COpTraits<O>::NonceDefaultSequentialSize>
+		 using		CAeadSealer =	Crypto::AuthEncAdDataSealer<O, S>;
+namespace			CTag =		Crypto::Tag;
+
+// Count every heap allocation made through the global operator new, from any thread, kept out of line so
+// the compiler doesn't pair the inlined malloc/free with new/delete expressions.
+static std::atomic<std::size_t>	allocations	{ 0 };
+
+[[gnu::noinline]] void* operator new (std::size_t size_)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* result { std::malloc(size_ > 0 ? size_ : 1) };
+    if(result == nullptr)
+	throw std::bad_alloc();
+    return result;
+}
+[[gnu::noinline]] void operator delete (void* pointer_) noexcept
+{
+    std::free(pointer_);
+}
+
+namespace {
+
+constexpr std::size_t		Messages	{ 100000 };
+constexpr std::size_t		MessageSize	{ 256 };
+constexpr std::size_t		BatchSize	{ 1000 };
+
+// Run f_, which handles n_ messages per call, until total_ messages are done and report per message.
+template <typename F> void measure(const char* name_, F f_, std::size_t n_ = 1, std::size_t total_ = Messages)
+{
+    const std::size_t startAllocations { allocations.load(std::memory_order_relaxed) };
+    const auto start { std::chrono::steady_clock::now() };
+    for(std::size_t i { 0 }; i != total_ / n_; ++i)
+	f_();
+    const auto stop { std::chrono::steady_clock::now() };
+    const std::size_t stopAllocations { allocations.load(std::memory_order_relaxed) };
+    std::cout << std::left << std::setw(40) << name_ << std::right << std::fixed << std::setprecision(2)
+	      << std::setw(10) << static_cast<double>(stopAllocations - startAllocations) / static_cast<double>(total_) << " allocs/msg"
+	      << std::setw(12) << static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count())
+				  / static_cast<double>(total_) << " ns/msg\n";
+}
+
+// Stop the benchmark with a VerificationError when a guarantee of what it times doesn't hold.
+void check(bool holds_, const char* what_)
+{
+    if(!holds_)
+    {
+	std::cerr << "  check failed: " << what_ << '\n';
+	throw Crypto::VerificationError();
+    }
+}
+
+// Whether open_ refuses cypher_ with a VerificationError.
+template <typename Opener> bool refuses(Opener& open_, const std::string& cypher_)
+{
+    try {
+	open_(cypher_);
+    }
+    catch(Crypto::VerificationError&)
+    {
+	return true;
+    }
+    return false;
+}
+
+// The opener Nonce is rewound before every open so the same cypher can be opened repeatedly.
+template <typename Sealer, typename Opener> void boxes(const char* name_, Sealer& seal_, Opener& open_)
+{
+    std::cout << name_ << " (" << MessageSize << " byte messages):\n";
+    const std::string		message		(MessageSize, 'x');
+    std::string			cypher;
+    measure("  seal std::string", [&]() { cypher= seal_(message); });
+    typename Opener::NonceType	nonce		{ seal_.nonce };
+    cypher= seal_(message);
+    measure("  open std::string", [&]() { open_.nonce= nonce; open_(cypher); });
+
+    unsigned char		in[MessageSize];
+    unsigned char		out[Sealer::ClearPadSize + MessageSize];
+    std::copy(message.begin(), message.end(), in);
+    measure("  seal caller buffer", [&]() { seal_(in, MessageSize, out, sizeof(out)); });
+    nonce= seal_.nonce;
+    seal_(in, MessageSize, out, sizeof(out));
+    measure("  open caller buffer", [&]() { open_.nonce= nonce; open_(out, MessageSize + Sealer::Overhead, in, MessageSize); });
+
+    measure("  seal in place (headroom)", [&]() { seal_(out, MessageSize, CTag::Headroom); });
+    nonce= seal_.nonce;
+    seal_(out, MessageSize, CTag::Headroom);
+    unsigned char		copy[sizeof(out)];
+    std::copy(out, out + sizeof(out), copy);
+    measure("  open in place (headroom)", [&]() {
+	std::copy(copy, copy + sizeof(copy), out);
+	open_.nonce= nonce;
+	open_(out, MessageSize + Sealer::Overhead, CTag::Headroom);
+    });
+}
+
+// Like boxes, with DataSize bytes of associated data and the tag room behind the message.
+template <typename Sealer, typename Opener> void aeads(const char* name_, Sealer& seal_, Opener& open_)
+{
+    constexpr std::size_t	DataSize	{ 32 };
+    std::cout << name_ << " (" << MessageSize << " byte messages, " << DataSize << " bytes associated data):\n";
+    const std::string		message		(MessageSize, 'x');
+    const std::string		data		(DataSize, 'd');
+    const unsigned char*	dP		{ reinterpret_cast<const unsigned char*>(data.data()) };
+    std::string			cypher;
+    measure("  seal std::string", [&]() { cypher= seal_(message, data); });
+    typename Opener::NonceType	nonce		{ seal_.nonce };
+    cypher= seal_(message, data);
+    measure("  open std::string", [&]() { open_.nonce= nonce; open_(cypher, data); });
+
+    unsigned char		in[MessageSize];
+    unsigned char		out[MessageSize + Sealer::Overhead];
+    std::copy(message.begin(), message.end(), in);
+    measure("  seal caller buffer", [&]() { seal_(in, MessageSize, dP, DataSize, out, sizeof(out)); });
+    nonce= seal_.nonce;
+    seal_(in, MessageSize, dP, DataSize, out, sizeof(out));
+    measure("  open caller buffer", [&]() { open_.nonce= nonce; open_(out, sizeof(out), dP, DataSize, in, MessageSize); });
+
+    measure("  seal in place (tailroom)", [&]() { seal_(out, MessageSize, dP, DataSize, CTag::Tailroom); });
+    nonce= seal_.nonce;
+    seal_(out, MessageSize, dP, DataSize, CTag::Tailroom);
+    unsigned char		copy[sizeof(out)];
+    std::copy(out, out + sizeof(out), copy);
+    measure("  open in place (tailroom)", [&]() {
+	std::copy(copy, copy + sizeof(copy), out);
+	open_.nonce= nonce;
+	open_(out, sizeof(out), dP, DataSize, CTag::Tailroom);
+    });
+#if CHLORIDE_HAS_AEAD_DETACHED
+
+    // A wire format with the tag in its header: split the combined cypher or seal detached.
+    unsigned char		wire[Sealer::Overhead + MessageSize];
+    measure("  seal combined and split the tag", [&]() {
+	seal_(in, MessageSize, dP, DataSize, out, sizeof(out));
+	std::copy(out + MessageSize, out + sizeof(out), wire);
+	std::copy(out, out + MessageSize, wire + Sealer::Overhead);
+    });
+    measure("  seal detached", [&]() {
+	const typename Sealer::AuthenticatorType tag { seal_(in, MessageSize, dP, DataSize, wire + Sealer::Overhead, CTag::Detached) };
+	std::copy(tag.begin(), tag.end(), wire);
+    });
+#endif
+}
+
+// Seal a message built from a header, metadata and payload, concatenated or as a Segment list.
+template <typename Sealer> void segments(const char* name_, Sealer& seal_)
+{
+    std::cout << name_ << " (16 + 32 + " << MessageSize << " byte segments):\n";
+    const std::string		header		(16, 'h');
+    const std::string		metadata	(32, 'm');
+    const std::string		payload		(MessageSize, 'p');
+    const Crypto::Segment	parts[]		{ header, metadata, payload };
+    unsigned char		out[16 + 32 + MessageSize + Sealer::Overhead];
+    measure("  seal concatenated std::string", [&]() {
+	const std::string message { header + metadata + payload };
+	seal_(reinterpret_cast<const unsigned char*>(message.data()), message.length(), out, sizeof(out));
+    });
+    measure("  seal Segment list", [&]() { seal_(std::begin(parts), std::end(parts), out, sizeof(out)); });
+}
+
+// Seal BatchSize messages per call into one reused Batch arena.
+template <typename Sealer> void batches(const char* name_, Sealer& seal_)
+{
+    std::cout << name_ << " (" << BatchSize << " x " << MessageSize << " byte messages per batch):\n";
+    const std::string		message		(MessageSize, 'x');
+    const std::vector<Crypto::Segment>
+				messages	(BatchSize, Crypto::Segment(message));
+    std::vector<std::string>	cyphers		(BatchSize);
+    measure("  seal std::string per message", [&]() {
+	for(auto& c : cyphers)
+	    c= seal_(message);
+    }, BatchSize);
+    Crypto::Batch		batch;
+    measure("  seal batch", [&]() { batch.seal(seal_, messages); }, BatchSize);
+}
+
+// Construct a Box sealer per message for a small set of peers, with and without a BoxKeyCache.
+void boxKeys()
+{
+    constexpr std::size_t	Peers		{ 16 };
+    std::cout << "Box sealer per message (" << Peers << " peers):\n";
+    const CKeyPair<COp::Box>	ours		{ CTag::Generate };
+    std::vector<CKeyPair<COp::Box>>
+				peers		(Peers);
+    for(auto& p : peers)
+    {
+	const CKeyPair<COp::Box> generated { CTag::Generate };
+	p= generated;
+    }
+    CNonce<COp::Box>		nonce		{ CTag::GenerateConstant };
+    const std::string		message		(MessageSize, 'x');
+    std::size_t			i		{ 0 };
+    measure("  seal without key cache", [&]() {
+	CBoxSealer<COp::Box> seal { peers[i++ % Peers].publicKey, ours.secretKey, nonce };
+	seal(message);
+    });
+    Crypto::BoxKeyCache<COp::Box>
+				cache		{ Peers };
+    measure("  seal with key cache", [&]() {
+	CBoxSealer<COp::Box> seal { cache, peers[i++ % Peers].publicKey, ours.secretKey, nonce };
+	seal(message);
+    });
+    std::cout << "  key cache hits " << cache.hits() << ", misses " << cache.misses() << '\n';
+}
+
+// Anonymous sealed boxes, generating the ephemeral KeyPair per message or taking it from a pool,
+// after checking both ways that they interoperate with crypto_box_seal.
+void sealedBoxes()
+{
+    constexpr std::size_t	PoolSize	{ 1024 };
+    std::cout << "Sealed box (" << MessageSize << " byte messages):\n";
+    const CKeyPair<COp::Box>	recipient	{ CTag::Generate };
+    const std::string		message		(MessageSize, 'x');
+    unsigned char		out[MessageSize + Crypto::SealedBoxSealer<COp::Box>::Overhead];
+    Crypto::SealedBoxSealer<COp::Box>
+				seal		{ recipient.publicKey };
+    Crypto::SealedBoxOpener<COp::Box>
+				open		{ recipient };
+    unsigned char		clear[MessageSize];
+    seal(reinterpret_cast<const unsigned char*>(message.data()), MessageSize, out, sizeof(out));
+    check(::crypto_box_seal_open(clear, out, sizeof(out), recipient.publicKey.begin(), recipient.secretKey.begin()) == 0
+	  && std::equal(message.begin(), message.end(), clear), "crypto_box_seal_open of a SealedBoxSealer cypher");
+    ::crypto_box_seal(out, reinterpret_cast<const unsigned char*>(message.data()), MessageSize, recipient.publicKey.begin());
+    check(open(std::string(reinterpret_cast<const char*>(out), sizeof(out))) == message, "SealedBoxOpener of a crypto_box_seal cypher");
+    measure("  seal generating ephemeral keys", [&]() {
+	seal(reinterpret_cast<const unsigned char*>(message.data()), MessageSize, out, sizeof(out));
+    }, 1, PoolSize / 2);
+    Crypto::EphemeralKeyPool<COp::Box>
+				pool		{ PoolSize };
+    while(pool.size() < PoolSize)
+	std::this_thread::yield();
+    Crypto::SealedBoxSealer<COp::Box>
+				poolSeal	{ pool, recipient.publicKey };
+    measure("  seal with ephemeral key pool", [&]() {
+	poolSeal(reinterpret_cast<const unsigned char*>(message.data()), MessageSize, out, sizeof(out));
+    }, 1, PoolSize / 2);
+}
+
+// Open batches of Box messages from many senders on ThreadPools of 1 up to hardware_concurrency threads.
+void parallelOpens()
+{
+    constexpr std::size_t	Senders		{ 64 };
+    const std::size_t		maxThreads	{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    std::cout << "Box parallel batch open (" << Senders << " senders, " << BatchSize << " x " << MessageSize
+	      << " byte messages per batch):\n";
+    const CKeyPair<COp::Box>	ours		{ CTag::Generate };
+    std::vector<CKeyPair<COp::Box>>
+				senders		(Senders);
+    std::vector<CNonce<COp::Box>>
+				sealNonces	(Senders);
+    std::vector<CNonce<COp::Box>>
+				openNonces	(Senders);
+    std::vector<std::unique_ptr<CBoxOpener<COp::Box>>>
+				openers;
+    std::vector<CBoxOpener<COp::Box>*>
+				batchOpeners;
+    std::vector<std::string>	cyphers;
+    const std::string		message		(MessageSize, 'x');
+    for(std::size_t i { 0 }; i != Senders; ++i)
+    {
+	const CKeyPair<COp::Box> generated { CTag::Generate };
+	senders[i]= generated;
+	sealNonces[i]= CNonce<COp::Box>(CTag::GenerateConstant);
+	openNonces[i]= sealNonces[i];
+	openers.emplace_back(new CBoxOpener<COp::Box>(senders[i].publicKey, ours.secretKey, openNonces[i]));
+    }
+    for(std::size_t i { 0 }; i != BatchSize; ++i)
+    {
+	CBoxSealer<COp::Box> seal { ours.publicKey, senders[i % Senders].secretKey, sealNonces[i % Senders] };
+	cyphers.push_back(seal(message));
+	batchOpeners.push_back(openers[i % Senders].get());
+    }
+    const std::vector<Crypto::Segment>
+				segments	(cyphers.begin(), cyphers.end());
+    const std::vector<CNonce<COp::Box>>
+				startNonces	(openNonces);
+    Crypto::Batch		batch;
+    for(std::size_t threads { 1 }; threads <= maxThreads; threads*= 2)
+    {
+	Crypto::ThreadPool	pool		{ threads };
+	const std::string	name		{ "  open on " + std::to_string(threads) + " thread(s)" };
+	measure(name.c_str(), [&]() {
+	    openNonces= startNonces;
+	    batch.open(pool, batchOpeners, segments);
+	}, BatchSize);
+    }
+}
+
+// Open AuthEncAdData batches in which every other message is forged, throwing per message or not at all.
+void forgedOpens()
+{
+    const std::size_t		maxThreads	{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    std::cout << "AuthEncAdData batch open, half forged (" << BatchSize << " x " << MessageSize << " byte messages per batch):\n";
+    const CSecKey<COp::AuthEncAdData>
+				key		{ CTag::Generate };
+    CNonce<COp::AuthEncAdData>	sealNonce	{ CTag::GenerateConstant };
+    CNonce<COp::AuthEncAdData>	openNonce	{ sealNonce };
+    const CNonce<COp::AuthEncAdData>
+				startNonce	{ sealNonce };
+    CAeadSealer<COp::AuthEncAdData>
+				seal		{ key, sealNonce };
+    Crypto::AuthEncAdDataOpener<COp::AuthEncAdData>
+				open		{ key, openNonce };
+    std::vector<std::string>	cyphers;
+    const std::string		message		(MessageSize, 'x');
+    for(std::size_t i { 0 }; i != BatchSize; ++i)
+    {
+	cyphers.push_back(seal(message));
+	if(i % 2)
+	    cyphers.back()[0]^= 1;
+    }
+    const std::vector<Crypto::Segment>
+				segments	(cyphers.begin(), cyphers.end());
+    unsigned char		out[MessageSize];
+    measure("  open throwing per message", [&]() {
+	openNonce= startNonce;
+	for(auto& c : segments)
+	    try
+	    {
+		open(c.pointer, c.length, out, sizeof(out));
+	    }
+	    catch(Crypto::VerificationError&)
+	    {
+		++openNonce;
+	    }
+    }, BatchSize);
+    Crypto::Batch		batch;
+    measure("  open batch with bitmap", [&]() {
+	openNonce= startNonce;
+	batch.open(open, segments, std::nothrow);
+    }, BatchSize);
+    for(std::size_t threads { 1 }; threads <= maxThreads; threads*= 2)
+    {
+	Crypto::ThreadPool	pool		{ threads };
+	const std::string	name		{ "  open batch on " + std::to_string(threads) + " thread(s)" };
+	measure(name.c_str(), [&]() {
+	    openNonce= startNonce;
+	    batch.open(open, pool, segments);
+	}, BatchSize);
+    }
+}
+
+// Send records of MessageSize bytes and more over a loopback socket pair to a reader thread, with a
+// write per std::string sealed record or through a RecordSealer and RecordOpener.
+void records()
+{
+    std::cout << "AuthEncAdData records over a socket pair (per record):\n";
+    const CSecKey<COp::AuthEncAdData>
+				key		{ CTag::Generate };
+    for(std::size_t size : { MessageSize, std::size_t { 0x1000 }, Crypto::Record::DefaultMaximumRecordSize })
+    {
+	const std::size_t	total		{ Messages * MessageSize / size };
+	const std::string	message		(size, 'x');
+	int			fds[2];
+	if(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+	    throw std::system_error(errno, std::generic_category());
+	CNonce<COp::AuthEncAdData>	sealNonce	{ CTag::GenerateConstant };
+	CNonce<COp::AuthEncAdData>	openNonce	{ sealNonce };
+	std::thread		reader		{ [&]() {
+	    Crypto::RecordOpener<COp::AuthEncAdData> open { key, openNonce, fds[1] };
+	    Crypto::Segment record;
+	    while(open(record))
+		;
+	} };
+	{
+	    CAeadSealer<COp::AuthEncAdData>
+				seal		{ key, sealNonce };
+	    unsigned char	header[Crypto::Record::HeaderSize];
+	    const std::string	name		{ "  " + std::to_string(size) + " bytes, write per record" };
+	    measure(name.c_str(), [&]() {
+		Crypto::Record::header(header, size);
+		const std::string cypher { seal(message, std::string(reinterpret_cast<const char*>(header), sizeof(header))) };
+		::iovec iov[] { { header, sizeof(header) }, { const_cast<char*>(cypher.data()), cypher.length() } };
+		Crypto::Record::write(fds[0], iov, 2);
+	    }, 1, total);
+	}
+	{
+	    Crypto::RecordSealer<COp::AuthEncAdData>
+				seal		{ key, sealNonce, fds[0] };
+	    const std::string	name		{ "  " + std::to_string(size) + " bytes, RecordSealer" };
+	    measure(name.c_str(), [&]() { seal(reinterpret_cast<const unsigned char*>(message.data()), size); }, 1, total);
+	}
+	::close(fds[0]);
+	reader.join();
+	::close(fds[1]);
+    }
+}
+
+// Seal and open a BlobSize byte blob in memory in chunks on 1 up to hardware_concurrency threads.
+template <typename Sealer, typename Opener> void chunkedBlobs(const char* name_)
+{
+    constexpr std::size_t	BlobSize	{ 0x1000000 };
+    const std::size_t		maxThreads	{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    std::cout << name_ << " (" << BlobSize << " byte blob, " << Crypto::Chunked::DefaultChunkSize
+	      << " byte chunks, per chunk):\n";
+    const typename Sealer::SecretKeyType
+				key		{ CTag::Generate };
+    const std::string		blob		(BlobSize, 'x');
+    std::string			cypher;
+    std::string			clear;
+    for(std::size_t threads { 1 }; threads <= maxThreads; threads*= 2)
+    {
+	Crypto::ThreadPool	pool		{ threads };
+	Sealer			seal		{ key, Crypto::Chunked::DefaultChunkSize, &pool };
+	Opener			open		{ key, &pool };
+	cypher.resize(seal.size(BlobSize));
+	clear.resize(BlobSize);
+	const std::size_t	chunks		{ BlobSize / Crypto::Chunked::DefaultChunkSize };
+	const std::string	sealName	{ "  seal on " + std::to_string(threads) + " thread(s)" };
+	measure(sealName.c_str(), [&]() {
+	    seal(reinterpret_cast<const unsigned char*>(&blob[0]), BlobSize, reinterpret_cast<unsigned char*>(&cypher[0]), cypher.length());
+	}, chunks, chunks * 16);
+	const std::string	openName	{ "  open on " + std::to_string(threads) + " thread(s)" };
+	measure(openName.c_str(), [&]() {
+	    open(reinterpret_cast<const unsigned char*>(&cypher[0]), cypher.length(), reinterpret_cast<unsigned char*>(&clear[0]), BlobSize);
+	}, chunks, chunks * 16);
+	check(clear == blob, "chunked open of the sealed blob");
+	const std::size_t	sealedChunkSize	{ Crypto::Chunked::DefaultChunkSize + Sealer::Overhead };
+	check(refuses(open, cypher.substr(0, cypher.length() - sealedChunkSize)), "chunked open refusing a truncated blob");
+	std::string		reordered	{ cypher };
+	std::swap_ranges(reordered.begin() + Sealer::HeaderSize, reordered.begin() + Sealer::HeaderSize + sealedChunkSize,
+			 reordered.begin() + Sealer::HeaderSize + sealedChunkSize);
+	check(refuses(open, reordered), "chunked open refusing reordered chunks");
+    }
+}
+
+// Hash a BlobSize byte blob with plain BLAKE2b and with TreeHash on 1 up to hardware_concurrency threads.
+void treeHashes()
+{
+    constexpr std::size_t	BlobSize	{ 0x1000000 };
+    const std::size_t		maxThreads	{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    const std::size_t		leaves		{ BlobSize / Crypto::TreeHashing::DefaultLeafSize };
+    std::cout << "GenericHash (" << BlobSize << " byte blob, " << Crypto::TreeHashing::DefaultLeafSize << " byte leaves, per leaf):\n";
+    const std::string		blob		(BlobSize, 'x');
+    const unsigned char*	p		{ reinterpret_cast<const unsigned char*>(blob.data()) };
+    measure("  plain BLAKE2b", [&]() {
+	Crypto::SizedHash<COp::GenericHashBlake2b, COpTraits<COp::GenericHashBlake2b>::HashSize>::Builder builder;
+	builder(p, BlobSize);
+	const Crypto::SizedHash<COp::GenericHashBlake2b, COpTraits<COp::GenericHashBlake2b>::HashSize> hash { builder };
+    }, leaves, leaves * 16);
+    for(std::size_t threads { 1 }; threads <= maxThreads; threads*= 2)
+    {
+	Crypto::ThreadPool	pool		{ threads };
+	const std::string	name		{ "  TreeHash on " + std::to_string(threads) + " thread(s)" };
+	measure(name.c_str(), [&]() { const Crypto::TreeHash<> hash { p, BlobSize, &pool }; }, leaves, leaves * 16);
+    }
+}
+
+// Xor a StreamSize byte buffer with a Streamer and with the matching raw crypto_stream_*_xor call.
+template <COp O, typename F> void streamers(const char* name_, F xor_)
+{
+    constexpr std::size_t	StreamSize	{ 0x100000 };
+    constexpr std::size_t	Passes		{ 256 };
+    std::cout << name_ << " (" << StreamSize << " byte buffers, per buffer, xor kernel " << Crypto::Memory::xorKernel() << "):\n";
+    const CSecKey<O>		key		{ CTag::Generate };
+    CNonce<O>			nonce		{ CTag::GenerateConstant };
+    Crypto::Streamer<O>		stream		{ key, nonce };
+    std::vector<unsigned char>	buffer		(StreamSize, 'x');
+    measure("  Streamer", [&]() { stream(buffer.data(), buffer.size()); }, 1, Passes);
+    measure("  raw crypto_stream_*_xor", [&]() {
+	xor_(buffer.data(), buffer.data(), buffer.size(), nonce.begin(), key.begin());
+    }, 1, Passes);
+}
+
+// Decrypt ReadSize bytes at a random offset into a FileSize byte stream, from the start with a Streamer or by seeking.
+void seekableStreams()
+{
+    constexpr std::size_t	FileSize	{ 0x1000000 };
+    constexpr std::size_t	ReadSize	{ 0x1000 };
+    constexpr std::size_t	Reads		{ 64 };
+    std::cout << "StreamChacha20 random reads (" << ReadSize << " bytes out of " << FileSize << ", per read):\n";
+    const CSecKey<COp::StreamChacha20>
+				key		{ CTag::Generate };
+    const CNonce<COp::StreamChacha20>
+				constant	{ CTag::GenerateConstant };
+    std::vector<unsigned char>	buffer		(FileSize, 'x');
+    std::size_t			offset		{ 0 };
+    measure("  Streamer from the start", [&]() {
+	CNonce<COp::StreamChacha20>	nonce		{ constant };
+	Crypto::Streamer<COp::StreamChacha20>
+					stream		{ key, nonce };
+	offset= (offset + 7919 * ReadSize + 13) % (FileSize - ReadSize);
+	stream(buffer.data(), offset + ReadSize);
+    }, 1, Reads);
+    Crypto::SeekableStreamer<COp::StreamChacha20>
+				seekable	{ key, constant };
+    measure("  SeekableStreamer", [&]() {
+	offset= (offset + 7919 * ReadSize + 13) % (FileSize - ReadSize);
+	seekable(offset, buffer.data() + offset, ReadSize);
+    }, 1, Reads);
+}
+
+// Check that xoring on pool_, after a partial pad, gives the bytes and Nonce of the sequential Streamer.
+void parallelStreamCheck(Crypto::ThreadPool& pool_, const CSecKey<COp::StreamChacha20>& key_, const CNonce<COp::StreamChacha20>& nonce_)
+{
+    constexpr std::size_t	CheckSize	{ 5 * Crypto::StreamerDefaultPadSize + 777 };
+    constexpr std::size_t	HeadSize	{ 1000 };
+    std::vector<unsigned char>	parallel	(CheckSize, 'x');
+    std::vector<unsigned char>	sequential	(CheckSize, 'x');
+    CNonce<COp::StreamChacha20>	parallelNonce	{ nonce_ };
+    CNonce<COp::StreamChacha20>	sequentialNonce	{ nonce_ };
+    Crypto::Streamer<COp::StreamChacha20>
+				parallelStream	{ key_, parallelNonce };
+    Crypto::Streamer<COp::StreamChacha20>
+				sequentialStream{ key_, sequentialNonce };
+    parallelStream(parallel.data(), HeadSize);
+    parallelStream(pool_, parallel.data() + HeadSize, CheckSize - HeadSize);
+    sequentialStream(sequential.data(), CheckSize);
+    check(parallel == sequential && parallelNonce == sequentialNonce, "parallel Streamer output equal to sequential output");
+}
+
+// Xor a StreamSize byte buffer with a StreamChacha20 Streamer on 1 up to hardware_concurrency threads,
+// after checking the parallel output against the sequential one.
+void parallelStreams()
+{
+    constexpr std::size_t	StreamSize	{ 0x4000000 };
+    const std::size_t		maxThreads	{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    std::cout << "StreamChacha20 parallel (" << StreamSize << " byte buffers, per buffer):\n";
+    const CSecKey<COp::StreamChacha20>
+				key		{ CTag::Generate };
+    CNonce<COp::StreamChacha20>	nonce		{ CTag::GenerateConstant };
+    Crypto::Streamer<COp::StreamChacha20>
+				stream		{ key, nonce };
+    std::vector<unsigned char>	buffer		(StreamSize, 'x');
+    for(std::size_t threads { 1 }; threads <= maxThreads; threads*= 2)
+    {
+	Crypto::ThreadPool	pool		{ threads };
+	parallelStreamCheck(pool, key, nonce);
+	const std::string	name		{ "  xor on " + std::to_string(threads) + " thread(s)" };
+	measure(name.c_str(), [&]() { stream(pool, buffer.data(), buffer.size()); }, 1, 8);
+    }
+}
+
+// Time every call of f_ on its own and report the median, 99th percentile and worst latency.
+template <typename F> void latencies(const char* name_, F f_, std::size_t calls_ = Messages)
+{
+    std::vector<double>		nanoseconds	(calls_);
+    for(auto& i : nanoseconds)
+    {
+	const auto start { std::chrono::steady_clock::now() };
+	f_();
+	const auto stop { std::chrono::steady_clock::now() };
+	i= static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+    }
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+    std::cout << std::left << std::setw(40) << name_ << std::right << std::fixed << std::setprecision(2)
+	      << std::setw(10) << nanoseconds[calls_ / 2] << " ns p50"
+	      << std::setw(12) << nanoseconds[calls_ * 99 / 100] << " ns p99"
+	      << std::setw(12) << nanoseconds.back() << " ns max\n";
+}
+
+// Xor PacketSize byte packets with a Streamer and a PrefetchStreamer, timing every packet.
+void prefetchStreams()
+{
+    constexpr std::size_t	PacketSize	{ 1400 };
+    std::cout << "StreamChacha20 packets (" << PacketSize << " bytes, " << Crypto::StreamerDefaultPadSize << " byte pads, per packet):\n";
+    const CSecKey<COp::StreamChacha20>
+				key		{ CTag::Generate };
+    CNonce<COp::StreamChacha20>	nonce		{ CTag::GenerateConstant };
+    CNonce<COp::StreamChacha20>	prefetchNonce	{ nonce };
+    Crypto::Streamer<COp::StreamChacha20>
+				stream		{ key, nonce };
+    Crypto::PrefetchStreamer<COp::StreamChacha20>
+				prefetch	{ key, prefetchNonce };
+    std::vector<unsigned char>	packet		(PacketSize, 'x');
+    latencies("  Streamer", [&]() { stream(packet.data(), packet.size()); });
+    latencies("  PrefetchStreamer", [&]() { prefetch(packet.data(), packet.size()); });
+}
+
+// Start a stream session, xor one PacketSize byte packet and end it, with pads of PadSize bytes.
+void pooledStreams()
+{
+    constexpr std::size_t	PacketSize	{ 1400 };
+    constexpr std::size_t	PadSize		{ 0x1000 };
+    std::cout << "StreamChacha20 sessions (" << PacketSize << " byte packet, " << PadSize << " byte pads, per session):\n";
+    const CSecKey<COp::StreamChacha20>
+				key		{ CTag::Generate };
+    CNonce<COp::StreamChacha20>	nonce		{ CTag::GenerateConstant };
+    Crypto::Memory::Pool	pool		{ PadSize };
+    std::vector<unsigned char>	packet		(PacketSize, 'x');
+    measure("  Streamer on the stack", [&]() {
+	Crypto::Streamer<COp::StreamChacha20, PadSize>
+				stream		{ key, nonce };
+	stream(packet.data(), packet.size());
+    });
+    measure("  PooledStreamer", [&]() {
+	Crypto::PooledStreamer<COp::StreamChacha20>
+				stream		{ pool, key, nonce };
+	stream(packet.data(), packet.size());
+    });
+}
+
+// Seal MessageSize byte messages under one key from 1 up to hardware_concurrency threads, through a
+// mutex around one AuthEncAdDataSealer or through one SharedAuthEncAdDataSealer.
+void sharedSeals()
+{
+    const std::size_t		maxThreads	{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    std::cout << "AuthEncAdData shared by threads (" << MessageSize << " byte messages, per message):\n";
+    const CSecKey<COp::AuthEncAdData>
+				key		{ CTag::Generate };
+    CNonce<COp::AuthEncAdData>	lockedNonce	{ CTag::GenerateConstant };
+    const CNonce<COp::AuthEncAdData>
+				sharedNonce	{ CTag::GenerateConstant };
+    CAeadSealer<COp::AuthEncAdData>
+				locked		{ key, lockedNonce };
+    Crypto::SharedAuthEncAdDataSealer<COp::AuthEncAdData>
+				shared		{ key, sharedNonce };
+    std::mutex			mutex;
+    const std::string		message		(MessageSize, 'x');
+    for(std::size_t threads { 1 }; threads <= maxThreads; threads*= 2)
+    {
+	const auto run { [&](const std::function<void(unsigned char*)>& seal_) {
+	    std::vector<std::thread> workers;
+	    for(std::size_t i { 0 }; i != threads; ++i)
+		workers.emplace_back([&]() {
+		    unsigned char out[MessageSize + CAeadSealer<COp::AuthEncAdData>::Overhead];
+		    for(std::size_t j { 0 }; j != Messages / threads; ++j)
+			seal_(out);
+		});
+	    for(auto& w : workers)
+		w.join();
+	} };
+	const std::string	lockedName	{ "  mutex on " + std::to_string(threads) + " thread(s)" };
+	measure(lockedName.c_str(), [&]() {
+	    run([&](unsigned char* out_) {
+		std::lock_guard<std::mutex> lock { mutex };
+		locked(reinterpret_cast<const unsigned char*>(message.data()), MessageSize, out_, MessageSize + locked.Overhead);
+	    });
+	}, Messages);
+	const std::string	sharedName	{ "  atomic Nonce on " + std::to_string(threads) + " thread(s)" };
+	measure(sharedName.c_str(), [&]() {
+	    run([&](unsigned char* out_) {
+		std::uint64_t sequence;
+		shared(sequence, reinterpret_cast<const unsigned char*>(message.data()), MessageSize, out_, MessageSize + shared.Overhead);
+	    });
+	}, Messages);
+    }
+}
+
+// Time picking the AuthEncAdDataEngine and sealing and opening with what it picked.
+void engineSeals()
+{
+    const auto			start		{ std::chrono::steady_clock::now() };
+    const COp			fastest		{ Crypto::AuthEncAdDataEngine::fastest() };
+    const auto			elapsed		{ std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start) };
+    std::cout << "AuthEncAdDataEngine picked " << (fastest == COp::AuthEncAdDataAes256Gcm ? "AES256-GCM" : "ChaCha20-Poly1305-IETF")
+	      << " in " << elapsed.count() << " usec (" << MessageSize << " byte messages):\n";
+    const CSecKey<COp::AuthEncAdData>
+				key		{ CTag::Generate };
+    Crypto::AuthEncAdDataEngineSealer<>::NonceType
+				sealNonce	{ CTag::GenerateConstant };
+    Crypto::AuthEncAdDataEngineSealer<>::NonceType
+				openNonce	{ sealNonce };
+    Crypto::AuthEncAdDataEngineSealer<>
+				seal		{ key, sealNonce, fastest };
+    Crypto::AuthEncAdDataEngineOpener<>
+				open		{ key, openNonce };
+    unsigned char		in[MessageSize] {};
+    unsigned char		out[MessageSize + seal.Overhead];
+    measure("  seal caller buffer", [&]() { seal(in, MessageSize, out, sizeof(out)); });
+    const auto			nonce		{ sealNonce };
+    seal(in, MessageSize, out, sizeof(out));
+    measure("  open caller buffer", [&]() { open.nonce= nonce; open(out, sizeof(out), in, MessageSize); });
+}
+
+// Seal AuthEncAdData messages with a fixed key and with a RotatingSealer switching epochs every
+// Budget messages, timing every message, with the next epoch prepared in the background.
+void rotatingSeals()
+{
+    constexpr std::size_t	Budget		{ 1000 };
+    std::cout << "AuthEncAdData rotating keys (" << MessageSize << " byte messages, " << Budget << " per epoch):\n";
+    const CSecKey<COp::AuthEncAdData>
+				key		{ CTag::Generate };
+    CNonce<COp::AuthEncAdData>	nonce		{ CTag::GenerateConstant };
+    const std::string		message		(MessageSize, 'x');
+    unsigned char		in[MessageSize] {};
+    unsigned char		out[MessageSize + Crypto::RotatingSealer<COp::AuthEncAdData>::Overhead];
+    CAeadSealer<COp::AuthEncAdData>
+				fixed		{ key, nonce };
+    latencies("  seal with fixed key", [&]() { fixed(in, MessageSize, out, sizeof(out)); });
+    Crypto::RotatingSealer<COp::AuthEncAdData>
+				rotating	{ key, nonce, Budget };
+    latencies("  seal, prepared in the background", [&]() { rotating(in, MessageSize, out, sizeof(out)); });
+    std::cout << "  epochs " << rotating.epoch() << '\n';
+}
+
+// Discards everything written to it.
+class NullBuf : public std::streambuf {
+protected:
+    int_type overflow(int_type c_) override			{ return traits_type::not_eof(c_); }
+    std::streamsize xsputn(const char*, std::streamsize n_) override	{ return n_; }
+};
+
+// Write a StreamSize byte blob through a std::ostream with a StreamerBuf and a ChunkedSealerBuf.
+void streamBufs()
+{
+    constexpr std::size_t	StreamSize	{ 0x1000000 };
+    constexpr std::size_t	WriteSize	{ 0x1000 };
+    std::cout << "std::ostream (" << StreamSize << " bytes in " << WriteSize << " byte writes, per write):\n";
+    const std::string		block		(WriteSize, 'x');
+    NullBuf			sink;
+    const CSecKey<COp::StreamChacha20>
+				streamKey	{ CTag::Generate };
+    CNonce<COp::StreamChacha20>	nonce		{ CTag::GenerateConstant };
+    Crypto::Streamer<COp::StreamChacha20>
+				stream		{ streamKey, nonce };
+    measure("  StreamerBuf", [&]() {
+	Crypto::StreamerBuf<Crypto::Streamer<COp::StreamChacha20>>
+				buffer		{ stream, sink };
+	std::ostream		out		{ &buffer };
+	for(std::size_t i { 0 }; i != StreamSize / WriteSize; ++i)
+	    out.write(block.data(), WriteSize);
+    }, StreamSize / WriteSize, 4 * StreamSize / WriteSize);
+    const CSecKey<COp::SecretBox>
+				boxKey		{ CTag::Generate };
+    measure("  ChunkedSealerBuf", [&]() {
+	Crypto::ChunkedSealerBuf<COp::SecretBox>
+				buffer		{ boxKey, sink };
+	std::ostream		out		{ &buffer };
+	for(std::size_t i { 0 }; i != StreamSize / WriteSize; ++i)
+	    out.write(block.data(), WriteSize);
+    }, StreamSize / WriteSize, 4 * StreamSize / WriteSize);
+}
+
+} // namespace
+
+int main(int, char* argv[])
+{
+    try {
+	Crypto::init();
+	std::cout << "Benchmarking libchloride v"
+		  << CHLORIDE_VERSION << '\n';
+
+	CSecKey<COp::SecretBox>		secretKey	{ CTag::Generate };
+	CNonce<COp::SecretBox>		secretSealNonce	{ CTag::GenerateConstant };
+	CNonce<COp::SecretBox>		secretOpenNonce	{ secretSealNonce };
+	CBoxSealer<COp::SecretBox>	secretBoxSeal	{ secretKey, secretSealNonce };
+	CBoxOpener<COp::SecretBox>	secretBoxOpen	{ secretKey, secretOpenNonce };
+	boxes("SecretBox", secretBoxSeal, secretBoxOpen);
+
+	CKeyPair<COp::Box>		sealKeys	{ CTag::Generate };
+	CKeyPair<COp::Box>		openKeys	{ CTag::Generate };
+	CNonce<COp::Box>		sealNonce	{ CTag::GenerateConstant };
+	CNonce<COp::Box>		openNonce	{ sealNonce };
+	CBoxSealer<COp::Box>		boxSeal		{ openKeys.publicKey, sealKeys.secretKey, sealNonce };
+	CBoxOpener<COp::Box>		boxOpen		{ sealKeys.publicKey, openKeys.secretKey, openNonce };
+	boxes("Box", boxSeal, boxOpen);
+
+	segments("SecretBox", secretBoxSeal);
+
+	batches("SecretBox", secretBoxSeal);
+	CSecKey<COp::AuthEncAdData>	aeadKey		{ CTag::Generate };
+	CNonce<COp::AuthEncAdData>	aeadSealNonce	{ CTag::GenerateConstant };
+	CAeadSealer<COp::AuthEncAdData>	aeadSeal	{ aeadKey, aeadSealNonce };
+	batches("AuthEncAdData", aeadSeal);
+	CNonce<COp::AuthEncAdData>	aeadOpenNonce	{ aeadSealNonce };
+	Crypto::AuthEncAdDataOpener<COp::AuthEncAdData>
+					aeadOpen	{ aeadKey, aeadOpenNonce };
+	aeads("AuthEncAdData", aeadSeal, aeadOpen);
+	if(Crypto::Operation_AuthEncAdDataAes256Gcm_Available())
+	{
+	    CSecKey<COp::AuthEncAdDataAes256Gcm>
+					gcmKey		{ CTag::Generate };
+	    CNonce<COp::AuthEncAdDataAes256Gcm>
+					gcmSealNonce	{ CTag::GenerateConstant };
+	    CNonce<COp::AuthEncAdDataAes256Gcm>
+					gcmOpenNonce	{ gcmSealNonce };
+	    CAeadSealer<COp::AuthEncAdDataAes256Gcm>
+					gcmSeal		{ gcmKey, gcmSealNonce };
+	    Crypto::AuthEncAdDataOpener<COp::AuthEncAdDataAes256Gcm>
+					gcmOpen		{ gcmKey, gcmOpenNonce };
+	    aeads("AuthEncAdDataAes256Gcm", gcmSeal, gcmOpen);
+	}
+#if CHLORIDE_HAS_AEAD_XCHACHA20POLY1305
+	CSecKey<COp::AuthEncAdDataXChacha20Poly1305Ietf>
+					xKey		{ CTag::Generate };
+	CNonce<COp::AuthEncAdDataXChacha20Poly1305Ietf>
+					xSealNonce	{ CTag::Generate };
+	CNonce<COp::AuthEncAdDataXChacha20Poly1305Ietf>
+					xOpenNonce	{ xSealNonce };
+	CAeadSealer<COp::AuthEncAdDataXChacha20Poly1305Ietf>
+					xSeal		{ xKey, xSealNonce };
+	Crypto::AuthEncAdDataOpener<COp::AuthEncAdDataXChacha20Poly1305Ietf>
+					xOpen		{ xKey, xOpenNonce };
+	aeads("AuthEncAdDataXChacha20Poly1305Ietf", xSeal, xOpen);
+#endif
+
+	boxKeys();
+	sealedBoxes();
+	parallelOpens();
+	forgedOpens();
+	chunkedBlobs<Crypto::ChunkedSealer<COp::SecretBox>, Crypto::ChunkedOpener<COp::SecretBox>>("Chunked SecretBox");
+	chunkedBlobs<Crypto::ChunkedAuthEncAdDataSealer<COp::AuthEncAdData>, Crypto::ChunkedAuthEncAdDataOpener<COp::AuthEncAdData>>(
+	    "Chunked AuthEncAdData");
+	streamers<COp::StreamChacha20>("StreamChacha20", ::crypto_stream_chacha20_xor);
+	streamers<COp::StreamSalsa20>("StreamSalsa20", ::crypto_stream_salsa20_xor);
+	seekableStreams();
+	parallelStreams();
+	prefetchStreams();
+	pooledStreams();
+	streamBufs();
+	sharedSeals();
+	engineSeals();
+	records();
+	rotatingSeals();
+	treeHashes();
+    }
+    catch(Crypto::VerificationError&)
+    {
+	std::cerr << argv[0] << " verification failure\n";
+	return 1;
+    }
+    catch(std::exception& e)
+    {
+	std::cerr << argv[0] << " fatal exception: " << e.what() << '\n';
+	return 1;
+    }
+    return 0;
+}
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -31,8 +31,17 @@
 #include "chloride/CryptoHash.h"
 #include "chloride/CryptoAuthenticate.h"
 #include "chloride/CryptoAuthEncAdData.h"
+#include "chloride/CryptoAuthEncAdDataEngine.h"
 #include "chloride/CryptoEncode.h"
 #include "chloride/CryptoMemory.h"
+#include "chloride/CryptoBatch.h"
+#include "chloride/CryptoSealedBox.h"
+#include "chloride/CryptoChunked.h"
+#include "chloride/CryptoReplay.h"
+#include "chloride/CryptoStreamBuf.h"
+#include "chloride/CryptoRecord.h"
+#include "chloride/CryptoRotating.h"
+#include "chloride/CryptoTreeHash.h"
 
 #endif /* CHLORIDE_H_ */
 
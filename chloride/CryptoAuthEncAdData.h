@@ -27,7 +27,17 @@
 
 #include <sodium/crypto_aead_aes256gcm.h>
 #include <sodium/crypto_aead_chacha20poly1305.h>
+#if CHLORIDE_HAS_AEAD_XCHACHA20POLY1305
+#include <sodium/crypto_aead_xchacha20poly1305.h>
+#endif
 
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "CryptoAuthenticate.h"
+#include "CryptoMemory.h"
 #include "CryptoSecretKey.h"
 #include "CryptoNonce.h"
 
@@ -102,8 +112,60 @@ template <> struct OperationTraits<Operation::AuthEncAdDataChacha20Poly1305Ietf>
     constexpr static std::size_t	AuthEncAdDataSize		{ crypto_aead_chacha20poly1305_ABYTES };
 };
 
+#if CHLORIDE_HAS_AEAD_XCHACHA20POLY1305
+// With 24 byte Nonces, Tag::Generate Nonces are safe, per message or per sender, without coordination.
+template <> struct OperationTraits<Operation::AuthEncAdDataXChacha20Poly1305Ietf> {
+    constexpr static bool		HasHash				{ false };
+    constexpr static bool		HasShortHash			{ false };
+    constexpr static bool		HasGenericHash			{ false };
+    constexpr static bool		HasPwHash			{ false };
+    constexpr static bool		HasBox				{ false };
+    constexpr static bool		HasSecretBox			{ false };
+    constexpr static bool		HasStream			{ false };
+    constexpr static bool		HasDiffieHellman		{ false };
+    constexpr static std::size_t	HashSize			{ 0 };
+    constexpr static std::size_t	MinimumHashSize			{ 0 };
+    constexpr static std::size_t	SecretKeySize			{ crypto_aead_xchacha20poly1305_ietf_KEYBYTES };
+    constexpr static std::size_t	MinimumSecretKeySize		{ 0 };
+    constexpr static std::size_t	PublicKeySize			{ 0 };
+    constexpr static std::size_t	SeedSize			{ 0 };
+    constexpr static std::size_t	SaltSize			{ 0 };
+    constexpr static std::size_t	NonceSize			{ crypto_aead_xchacha20poly1305_ietf_NPUBBYTES };
+    constexpr static std::size_t	NonceDefaultSequentialSize	{ NonceSize / 2 };
+    constexpr static std::size_t	AuthenticatorSize		{ 0 };
+    constexpr static std::size_t	SignatureSize			{ 0 };
+    constexpr static std::size_t	AuthEncAdDataSize		{ crypto_aead_xchacha20poly1305_ietf_ABYTES };
+};
+#endif
+
 /*
- * AuthEncAdDataSealer.
+ * AuthEncAdDataAuthenticator. The tag of a detached AuthEncAdData cypher.
+ */
+template <Operation O> class AuthEncAdDataAuthenticator : public AuthenticatorBase<OperationTraits<O>::AuthEncAdDataSize> {
+    static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal AuthEncAdDataAuthenticator type!");
+public:
+    constexpr static Operation				Oper		{ O };
+    constexpr static std::size_t			Size		{ OperationTraits<Oper>::AuthEncAdDataSize };
+
+    AuthEncAdDataAuthenticator() noexcept = default;
+    explicit AuthEncAdDataAuthenticator(const unsigned char* raw_) noexcept
+	: AuthenticatorBase<Size>(raw_)
+    {}
+    template <typename I> AuthEncAdDataAuthenticator(I begin_, I end_)
+	: AuthenticatorBase<Size>(begin_, end_)
+    {}
+    explicit AuthEncAdDataAuthenticator(const std::string& s_)
+	: AuthenticatorBase<Size>(s_.begin(), s_.end())
+    {}
+};
+
+/*
+ * AuthEncAdDataSealer. Caller buffers receive Overhead bytes more than the message, optionally with
+ * associated data from a separate span. The Tailroom variant encrypts in place and appends the tag,
+ * so it needs Overhead bytes of room behind the message. The Detached variants (libsodium >= 1.0.10)
+ * return the tag separately and the cypher is as long as the message, in place or not. The explicit
+ * Nonce variant leaves the nonce member alone, so it may be called from several threads at once, and
+ * with XChaCha20-Poly1305 (libsodium >= 1.0.12) it may take a fresh Tag::Generate Nonce every call.
  */
 template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize> class AuthEncAdDataSealer {
     static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal AuthEncAdDataSealer type!");
@@ -111,10 +173,12 @@ public:
     constexpr static Operation 				Oper			{ O };
     constexpr static std::size_t			NonceSequentialSize	{ S };
     constexpr static std::size_t			PadSize			{ OperationTraits<Oper>::AuthEncAdDataSize };
+    constexpr static std::size_t			Overhead		{ PadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef AuthEncAdDataAuthenticator<Oper>			AuthenticatorType;
 
     NonceType&						nonce;
     const SecretKeyBaseType&				secretKey;
@@ -138,27 +202,122 @@ public:
 	return _oper(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
 		     reinterpret_cast<const unsigned char*>(&data_[0]), data_.length());
     }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	return operator()(mP_, mN_, nullptr, 0, cP_, cN_);
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	return _oper(mP_, mN_, dP_, dN_, cP_);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, Tag::TailroomTag)
+    {
+	return _oper(p_, n_, nullptr, 0, p_);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, const unsigned char* dP_, std::size_t dN_, Tag::TailroomTag)
+    {
+	return _oper(p_, n_, dP_, dN_, p_);
+    }
+    std::size_t operator () (const NonceType& n_, const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* cP_) const
+    {
+	return _seal(n_, mP_, mN_, dP_, dN_, cP_);
+    }
+#if CHLORIDE_HAS_AEAD_DETACHED
+    AuthenticatorType operator () (unsigned char* p_, std::size_t n_, Tag::DetachedTag)
+    {
+	return operator()(p_, n_, nullptr, 0, p_, Tag::Detached);
+    }
+    AuthenticatorType operator () (const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+				   unsigned char* cP_, Tag::DetachedTag)
+    {
+	AuthenticatorType result;
+	switch(Oper) {
+	case Operation::AuthEncAdDataChacha20Poly1305:
+	    ::crypto_aead_chacha20poly1305_encrypt_detached(cP_, result.begin(), nullptr, mP_, mN_, dP_, dN_, nullptr, nonce.begin(),
+							    secretKey.begin());
+	    break;
+	case Operation::AuthEncAdDataChacha20Poly1305Ietf:
+	    ::crypto_aead_chacha20poly1305_ietf_encrypt_detached(cP_, result.begin(), nullptr, mP_, mN_, dP_, dN_, nullptr, nonce.begin(),
+								 secretKey.begin());
+	    break;
+#if CHLORIDE_HAS_AEAD_XCHACHA20POLY1305
+	case Operation::AuthEncAdDataXChacha20Poly1305Ietf:
+	    ::crypto_aead_xchacha20poly1305_ietf_encrypt_detached(cP_, result.begin(), nullptr, mP_, mN_, dP_, dN_, nullptr, nonce.begin(),
+								  secretKey.begin());
+	    break;
+#endif
+	default:
+	    throw Exception(Exception::ImplMsg);
+	}
+	++nonce;
+	return result;
+    }
+#endif
+    std::string operator () (const std::vector<Segment>& message_)
+    {
+	return operator()(message_, std::vector<Segment>());
+    }
+    std::string operator () (const std::vector<Segment>& message_, const std::vector<Segment>& data_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t mN { _scratch(message_.data(), message_.data() + message_.size()) };
+	const std::size_t dN { _scratch(data_.data(), data_.data() + data_.size()) };
+	return _oper(_scratch.begin(), mN, _scratch.begin() + mN, dN);
+    }
+    std::size_t operator () (const Segment* mBegin_, const Segment* mEnd_, unsigned char* cP_, std::size_t cN_)
+    {
+	return operator()(mBegin_, mEnd_, nullptr, nullptr, cP_, cN_);
+    }
+    std::size_t operator () (const Segment* mBegin_, const Segment* mEnd_, const Segment* dBegin_, const Segment* dEnd_,
+			     unsigned char* cP_, std::size_t cN_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t mN { _scratch(mBegin_, mEnd_) };
+	const std::size_t dN { _scratch(dBegin_, dEnd_) };
+	if(cN_ < mN + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	return _oper(_scratch.begin(), mN, _scratch.begin() + mN, dN, cP_);
+    }
 
 private:
+    Memory::Scratch					_scratch;
+
     std::string _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_)
     {
 	std::string result(mN_ + PadSize, '\0');
+	result.resize(_oper(mP_, mN_, dP_, dN_, reinterpret_cast<unsigned char*>(&result[0])));
+	return result;
+    }
+    std::size_t _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_, unsigned char* rP_)
+    {
+	const std::size_t result { _seal(nonce, mP_, mN_, dP_, dN_, rP_) };
+	++nonce;
+	return result;
+    }
+    std::size_t _seal(const NonceType& n_, const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_,
+		      unsigned char* rP_) const
+    {
 	unsigned long long rl;
 	switch(Oper) {
 	case Operation::AuthEncAdDataChacha20Poly1305:
-	    ::crypto_aead_chacha20poly1305_encrypt(reinterpret_cast<unsigned char*>(&result[0]), &rl, mP_, mN_,
-						   dP_, dN_, nullptr, nonce.begin(), secretKey.begin());
+	    ::crypto_aead_chacha20poly1305_encrypt(rP_, &rl, mP_, mN_, dP_, dN_, nullptr, n_.begin(), secretKey.begin());
 	    break;
 	case Operation::AuthEncAdDataChacha20Poly1305Ietf:
-	    ::crypto_aead_chacha20poly1305_ietf_encrypt(reinterpret_cast<unsigned char*>(&result[0]), &rl, mP_, mN_,
-							dP_, dN_, nullptr, nonce.begin(), secretKey.begin());
+	    ::crypto_aead_chacha20poly1305_ietf_encrypt(rP_, &rl, mP_, mN_, dP_, dN_, nullptr, n_.begin(), secretKey.begin());
 	    break;
+#if CHLORIDE_HAS_AEAD_XCHACHA20POLY1305
+	case Operation::AuthEncAdDataXChacha20Poly1305Ietf:
+	    ::crypto_aead_xchacha20poly1305_ietf_encrypt(rP_, &rl, mP_, mN_, dP_, dN_, nullptr, n_.begin(), secretKey.begin());
+	    break;
+#endif
 	default:
 	    throw Exception(Exception::ImplMsg);
 	}
-	result.resize(rl);
-	++nonce;
-	return result;
+	return static_cast<std::size_t>(rl);
     }
 };
 
@@ -167,10 +326,12 @@ public:
     constexpr static Operation 				Oper			{ Operation::AuthEncAdDataAes256Gcm };
     constexpr static std::size_t			NonceSequentialSize	{ S };
     constexpr static std::size_t			PadSize			{ OperationTraits<Oper>::AuthEncAdDataSize };
+    constexpr static std::size_t			Overhead		{ PadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef AuthEncAdDataAuthenticator<Oper>			AuthenticatorType;
 
     NonceType&						nonce;
 
@@ -200,24 +361,183 @@ public:
 	return _oper(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
 		     reinterpret_cast<const unsigned char*>(&data_[0]), data_.length());
     }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	return operator()(mP_, mN_, nullptr, 0, cP_, cN_);
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	return _oper(mP_, mN_, dP_, dN_, cP_);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, Tag::TailroomTag)
+    {
+	return _oper(p_, n_, nullptr, 0, p_);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, const unsigned char* dP_, std::size_t dN_, Tag::TailroomTag)
+    {
+	return _oper(p_, n_, dP_, dN_, p_);
+    }
+    std::size_t operator () (const NonceType& n_, const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* cP_) const
+    {
+	return _seal(n_, mP_, mN_, dP_, dN_, cP_);
+    }
+#if CHLORIDE_HAS_AEAD_DETACHED
+    AuthenticatorType operator () (unsigned char* p_, std::size_t n_, Tag::DetachedTag)
+    {
+	return operator()(p_, n_, nullptr, 0, p_, Tag::Detached);
+    }
+    AuthenticatorType operator () (const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+				   unsigned char* cP_, Tag::DetachedTag)
+    {
+	AuthenticatorType result;
+	::crypto_aead_aes256gcm_encrypt_detached_afternm(cP_, result.begin(), nullptr, mP_, mN_, dP_, dN_, nullptr, nonce.begin(), &_state);
+	++nonce;
+	return result;
+    }
+#endif
+    std::string operator () (const std::vector<Segment>& message_)
+    {
+	return operator()(message_, std::vector<Segment>());
+    }
+    std::string operator () (const std::vector<Segment>& message_, const std::vector<Segment>& data_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t mN { _scratch(message_.data(), message_.data() + message_.size()) };
+	const std::size_t dN { _scratch(data_.data(), data_.data() + data_.size()) };
+	return _oper(_scratch.begin(), mN, _scratch.begin() + mN, dN);
+    }
+    std::size_t operator () (const Segment* mBegin_, const Segment* mEnd_, unsigned char* cP_, std::size_t cN_)
+    {
+	return operator()(mBegin_, mEnd_, nullptr, nullptr, cP_, cN_);
+    }
+    std::size_t operator () (const Segment* mBegin_, const Segment* mEnd_, const Segment* dBegin_, const Segment* dEnd_,
+			     unsigned char* cP_, std::size_t cN_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t mN { _scratch(mBegin_, mEnd_) };
+	const std::size_t dN { _scratch(dBegin_, dEnd_) };
+	if(cN_ < mN + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	return _oper(_scratch.begin(), mN, _scratch.begin() + mN, dN, cP_);
+    }
 
 private:
     ::crypto_aead_aes256gcm_state			_state;
+    Memory::Scratch					_scratch;
 
     std::string _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_)
     {
 	std::string result(mN_ + PadSize, '\0');
-	unsigned long long rl;
-	::crypto_aead_aes256gcm_encrypt_afternm(reinterpret_cast<unsigned char*>(&result[0]), &rl, mP_, mN_,
-						dP_, dN_, nullptr, nonce.begin(), &_state);
-	result.resize(rl);
+	result.resize(_oper(mP_, mN_, dP_, dN_, reinterpret_cast<unsigned char*>(&result[0])));
+	return result;
+    }
+    std::size_t _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_, unsigned char* rP_)
+    {
+	const std::size_t result { _seal(nonce, mP_, mN_, dP_, dN_, rP_) };
 	++nonce;
 	return result;
     }
+    std::size_t _seal(const NonceType& n_, const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_,
+		      unsigned char* rP_) const noexcept
+    {
+	unsigned long long rl;
+	::crypto_aead_aes256gcm_encrypt_afternm(rP_, &rl, mP_, mN_, dP_, dN_, nullptr, n_.begin(), &_state);
+	return static_cast<std::size_t>(rl);
+    }
 };
 
 /*
- * AuthEncAdDataOpener.
+ * SharedAuthEncAdDataSealer. AuthEncAdDataSealer for many threads at once under one key, including
+ * one precomputed AES256-GCM state: every message reserves the next sequence number with an atomic
+ * fetch_add and is sealed under the Nonce plus that number, without locks. Messages may leave in any
+ * order, so each call hands back its sequence number, which a ReplayOpener on the same Nonce takes.
+ * Only the constant part of the given Nonce is used: sequence numbers count from a zero sequential part,
+ * as the ReplayOpener does.
+ * Running out of sequential Nonce space throws on every later call.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize> class SharedAuthEncAdDataSealer {
+    static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal SharedAuthEncAdDataSealer type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ AuthEncAdDataSealer<Oper, S>::Overhead };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    const NonceType					nonce;
+
+    SharedAuthEncAdDataSealer(const SecretKeyBaseType& sk_, const NonceType& n_)
+	: nonce		{ n_.constantBegin(), n_.constantEnd(), Tag::SpecifyConstant }
+	, _unused	{ nonce }
+	, _sealer	{ sk_, _unused }
+	, _next		{ 0 }
+    {}
+    SharedAuthEncAdDataSealer(const SharedAuthEncAdDataSealer&) = delete;
+    SharedAuthEncAdDataSealer(SharedAuthEncAdDataSealer&&) = delete;
+
+    SharedAuthEncAdDataSealer& operator = (const SharedAuthEncAdDataSealer&) = delete;
+    SharedAuthEncAdDataSealer& operator = (SharedAuthEncAdDataSealer&&) = delete;
+
+    std::string operator () (std::uint64_t& sequence_, const std::string& message_)
+    {
+	return operator()(sequence_, message_, std::string());
+    }
+    std::string operator () (std::uint64_t& sequence_, const std::string& message_, const std::string& data_)
+    {
+	std::string result(message_.length() + Overhead, '\0');
+	operator()(sequence_, reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
+		   reinterpret_cast<const unsigned char*>(&data_[0]), data_.length(), reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (std::uint64_t& sequence_, const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	return operator()(sequence_, mP_, mN_, nullptr, 0, cP_, cN_);
+    }
+    std::size_t operator () (std::uint64_t& sequence_, const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	const std::uint64_t sequence { _next.fetch_add(1, std::memory_order_relaxed) };
+	// Past Limit the counter keeps growing but can't wrap around in practice, so overflow stays sticky.
+	if(sequence >= Limit)
+	    throw Exception(Exception::OverflowMsg);
+	const std::size_t result { _sealer(nonce + sequence, mP_, mN_, dP_, dN_, cP_) };
+	sequence_= sequence;
+	return result;
+    }
+
+    // The number of sequence numbers handed out so far.
+    std::uint64_t sealed() const noexcept
+    {
+	const std::uint64_t next { _next.load(std::memory_order_relaxed) };
+	return next < Limit ? next : Limit;
+    }
+
+private:
+    // Every sequence number below Limit fits the Nonce sequential part, which starts at zero, and the
+    // counter has at least 2^63 increments of headroom past Limit before it could wrap around.
+    constexpr static std::uint64_t			Limit			{ NonceSequentialSize >= 8 ? std::uint64_t { 1 } << 63
+										  : std::uint64_t { 1 } << (8 * (NonceSequentialSize % 8)) };
+
+    static_assert(Limit <= std::uint64_t { 1 } << 63, "SharedAuthEncAdDataSealer Limit leaves no headroom!");
+
+    NonceType						_unused;
+    AuthEncAdDataSealer<Oper, NonceSequentialSize>	_sealer;
+    std::atomic<std::uint64_t>				_next;
+};
+
+/*
+ * AuthEncAdDataOpener. Caller buffers receive Overhead bytes less than the cypher, the Tailroom
+ * variant decrypts in place and leaves the tag bytes behind the message, the Detached variants
+ * verify a separate tag. The std::nothrow variants open with an explicit Nonce, leave the nonce
+ * member alone and return false on failure.
  */
 template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize> class AuthEncAdDataOpener {
     static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal AuthEncAdDataOpener type!");
@@ -225,10 +545,12 @@ public:
     constexpr static Operation 				Oper			{ O };
     constexpr static std::size_t			NonceSequentialSize	{ S };
     constexpr static std::size_t			PadSize			{ OperationTraits<Oper>::AuthEncAdDataSize };
+    constexpr static std::size_t			Overhead		{ PadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef AuthEncAdDataAuthenticator<Oper>			AuthenticatorType;
 
     NonceType&						nonce;
     const SecretKeyBaseType&				secretKey;
@@ -252,30 +574,104 @@ public:
 	return _oper(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
 		     reinterpret_cast<const unsigned char*>(&data_[0]), data_.length());
     }
-
-private:
-    std::string _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_)
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
     {
-	std::string result(mN_ + PadSize, '\0');
-	unsigned long long rl;
+	return operator()(cP_, cN_, nullptr, 0, mP_, mN_);
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* mP_, std::size_t mN_)
+    {
+	if(cN_ < Overhead)
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+	return _oper(cP_, cN_, dP_, dN_, mP_);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, Tag::TailroomTag)
+    {
+	return operator()(p_, n_, nullptr, 0, Tag::Tailroom);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, const unsigned char* dP_, std::size_t dN_, Tag::TailroomTag)
+    {
+	if(n_ < Overhead)
+	    throw VerificationError();
+	return _oper(p_, n_, dP_, dN_, p_);
+    }
+#if CHLORIDE_HAS_AEAD_DETACHED
+    void operator () (unsigned char* p_, std::size_t n_, const AuthenticatorType& a_)
+    {
+	operator()(p_, n_, nullptr, 0, a_, p_);
+    }
+    void operator () (const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_, const AuthenticatorType& a_,
+		      unsigned char* mP_)
+    {
+	int result;
 	switch(Oper) {
 	case Operation::AuthEncAdDataChacha20Poly1305:
-	    if(::crypto_aead_chacha20poly1305_decrypt(reinterpret_cast<unsigned char*>(&result[0]), &rl, nullptr, mP_, mN_,
-						      dP_, dN_, nonce.begin(), secretKey.begin()))
-		throw VerificationError();
+	    result= ::crypto_aead_chacha20poly1305_decrypt_detached(mP_, nullptr, cP_, cN_, a_.begin(), dP_, dN_, nonce.begin(),
+								     secretKey.begin());
 	    break;
 	case Operation::AuthEncAdDataChacha20Poly1305Ietf:
-	    if(::crypto_aead_chacha20poly1305_ietf_decrypt(reinterpret_cast<unsigned char*>(&result[0]), &rl, nullptr, mP_, mN_,
-							   dP_, dN_, nonce.begin(), secretKey.begin()))
-		throw VerificationError();
+	    result= ::crypto_aead_chacha20poly1305_ietf_decrypt_detached(mP_, nullptr, cP_, cN_, a_.begin(), dP_, dN_, nonce.begin(),
+									  secretKey.begin());
 	    break;
+#if CHLORIDE_HAS_AEAD_XCHACHA20POLY1305
+	case Operation::AuthEncAdDataXChacha20Poly1305Ietf:
+	    result= ::crypto_aead_xchacha20poly1305_ietf_decrypt_detached(mP_, nullptr, cP_, cN_, a_.begin(), dP_, dN_, nonce.begin(),
+									   secretKey.begin());
+	    break;
+#endif
 	default:
 	    throw Exception(Exception::ImplMsg);
 	}
-	result.resize(rl);
+	if(result)
+	    throw VerificationError();
 	++nonce;
+    }
+#endif
+    bool operator () (const NonceType& n_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::nothrow_t) const noexcept
+    {
+	return cN_ >= Overhead && _open(n_, cP_, cN_, nullptr, 0, mP_);
+    }
+    bool operator () (const NonceType& n_, const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_,
+		      unsigned char* mP_, std::nothrow_t) const noexcept
+    {
+	return cN_ >= Overhead && _open(n_, cP_, cN_, dP_, dN_, mP_);
+    }
+
+private:
+    std::string _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_)
+    {
+	if(mN_ < PadSize)
+	    throw VerificationError();
+	std::string result(mN_ - PadSize, '\0');
+	result.resize(_oper(mP_, mN_, dP_, dN_, reinterpret_cast<unsigned char*>(&result[0])));
 	return result;
     }
+    std::size_t _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_, unsigned char* rP_)
+    {
+	if(!_open(nonce, mP_, mN_, dP_, dN_, rP_))
+	    throw VerificationError();
+	++nonce;
+	return mN_ - PadSize;
+    }
+    bool _open(const NonceType& n_, const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_,
+	       unsigned char* rP_) const
+    {
+	unsigned long long rl;
+	switch(Oper) {
+	case Operation::AuthEncAdDataChacha20Poly1305:
+	    return ::crypto_aead_chacha20poly1305_decrypt(rP_, &rl, nullptr, mP_, mN_, dP_, dN_, n_.begin(), secretKey.begin()) == 0;
+	case Operation::AuthEncAdDataChacha20Poly1305Ietf:
+	    return ::crypto_aead_chacha20poly1305_ietf_decrypt(rP_, &rl, nullptr, mP_, mN_, dP_, dN_, n_.begin(), secretKey.begin()) == 0;
+#if CHLORIDE_HAS_AEAD_XCHACHA20POLY1305
+	case Operation::AuthEncAdDataXChacha20Poly1305Ietf:
+	    return ::crypto_aead_xchacha20poly1305_ietf_decrypt(rP_, &rl, nullptr, mP_, mN_, dP_, dN_, n_.begin(), secretKey.begin()) == 0;
+#endif
+	default:
+	    throw Exception(Exception::ImplMsg);
+	}
+    }
 };
 
 template <std::size_t S> class AuthEncAdDataOpener<Operation::AuthEncAdDataAes256Gcm, S> {
@@ -283,10 +679,12 @@ public:
     constexpr static Operation 				Oper			{ Operation::AuthEncAdDataAes256Gcm };
     constexpr static std::size_t			NonceSequentialSize	{ S };
     constexpr static std::size_t			PadSize			{ OperationTraits<Oper>::AuthEncAdDataSize };
+    constexpr static std::size_t			Overhead		{ PadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef AuthEncAdDataAuthenticator<Oper>			AuthenticatorType;
 
     NonceType&						nonce;
 
@@ -316,21 +714,76 @@ public:
 	return _oper(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
 		     reinterpret_cast<const unsigned char*>(&data_[0]), data_.length());
     }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	return operator()(cP_, cN_, nullptr, 0, mP_, mN_);
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* mP_, std::size_t mN_)
+    {
+	if(cN_ < Overhead)
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+	return _oper(cP_, cN_, dP_, dN_, mP_);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, Tag::TailroomTag)
+    {
+	return operator()(p_, n_, nullptr, 0, Tag::Tailroom);
+    }
+    std::size_t operator () (unsigned char* p_, std::size_t n_, const unsigned char* dP_, std::size_t dN_, Tag::TailroomTag)
+    {
+	if(n_ < Overhead)
+	    throw VerificationError();
+	return _oper(p_, n_, dP_, dN_, p_);
+    }
+#if CHLORIDE_HAS_AEAD_DETACHED
+    void operator () (unsigned char* p_, std::size_t n_, const AuthenticatorType& a_)
+    {
+	operator()(p_, n_, nullptr, 0, a_, p_);
+    }
+    void operator () (const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_, const AuthenticatorType& a_,
+		      unsigned char* mP_)
+    {
+	if(::crypto_aead_aes256gcm_decrypt_detached_afternm(mP_, nullptr, cP_, cN_, a_.begin(), dP_, dN_, nonce.begin(), &_state))
+	    throw VerificationError();
+	++nonce;
+    }
+#endif
+    bool operator () (const NonceType& n_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::nothrow_t) const noexcept
+    {
+	return cN_ >= Overhead && _open(n_, cP_, cN_, nullptr, 0, mP_);
+    }
+    bool operator () (const NonceType& n_, const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_,
+		      unsigned char* mP_, std::nothrow_t) const noexcept
+    {
+	return cN_ >= Overhead && _open(n_, cP_, cN_, dP_, dN_, mP_);
+    }
 
 private:
     ::crypto_aead_aes256gcm_state			_state;
 
     std::string _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_)
     {
-	std::string result(mN_ + PadSize, '\0');
-	unsigned long long rl;
-	if(::crypto_aead_aes256gcm_decrypt_afternm(reinterpret_cast<unsigned char*>(&result[0]), &rl, nullptr, mP_, mN_,
-						   dP_, dN_, nonce.begin(), &_state))
+	if(mN_ < PadSize)
 	    throw VerificationError();
-	result.resize(rl);
-	++nonce;
+	std::string result(mN_ - PadSize, '\0');
+	result.resize(_oper(mP_, mN_, dP_, dN_, reinterpret_cast<unsigned char*>(&result[0])));
 	return result;
     }
+    std::size_t _oper(const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_, unsigned char* rP_)
+    {
+	if(!_open(nonce, mP_, mN_, dP_, dN_, rP_))
+	    throw VerificationError();
+	++nonce;
+	return mN_ - PadSize;
+    }
+    bool _open(const NonceType& n_, const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_,std::size_t dN_,
+	       unsigned char* rP_) const noexcept
+    {
+	unsigned long long rl;
+	return ::crypto_aead_aes256gcm_decrypt_afternm(rP_, &rl, nullptr, mP_, mN_, dP_, dN_, n_.begin(), &_state) == 0;
+    }
 };
 
 /*
@@ -0,0 +1,213 @@
+/*
+** CryptoAuthEncAdDataEngine.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHLORIDE_CRYPTOAUTHENCADDATAENGINE_H_
+#define CHLORIDE_CRYPTOAUTHENCADDATAENGINE_H_
+
+#include <memory>
+#include <new>
+
+#include "CryptoAuthEncAdData.h"
+
+namespace Crypto {
+/*
+ * AuthEncAdDataEngine. Picks AES256-GCM or ChaCha20-Poly1305-IETF at runtime, both take the same
+ * key, Nonce and tag sizes. fastest() measures both on this CPU once, on first use, measure() every
+ * time it is called. An engine cypher starts with the id byte of its Operation, so peers that picked
+ * differently still interoperate.
+ */
+class AuthEncAdDataEngine {
+public:
+    constexpr static std::size_t			HeaderSize		{ 1 };
+    constexpr static std::size_t			SecretKeySize		{ OperationTraits<Operation::AuthEncAdData>::SecretKeySize };
+    constexpr static std::size_t			NonceSize		{ OperationTraits<Operation::AuthEncAdData>::NonceSize };
+    constexpr static std::size_t			Overhead		{ HeaderSize + OperationTraits<Operation::AuthEncAdData>::AuthEncAdDataSize };
+
+    static_assert(OperationTraits<Operation::AuthEncAdDataAes256Gcm>::SecretKeySize == SecretKeySize
+		  && OperationTraits<Operation::AuthEncAdDataAes256Gcm>::NonceSize == NonceSize
+		  && OperationTraits<Operation::AuthEncAdDataAes256Gcm>::AuthEncAdDataSize + HeaderSize == Overhead,
+		  "AuthEncAdDataEngine Operations differ in size!");
+
+    static Operation fastest();
+    static Operation measure();
+
+    static bool available(Operation oper_) noexcept;
+    static unsigned char id(Operation oper_);
+    static Operation oper(unsigned char id_);
+};
+
+/*
+ * AuthEncAdDataEngineSealer. AuthEncAdDataSealer for the Operation an AuthEncAdDataEngine picked, the
+ * choice is made per sealer and dispatched once per message.
+ */
+template <std::size_t S = OperationTraits<Operation::AuthEncAdData>::NonceDefaultSequentialSize> class AuthEncAdDataEngineSealer {
+public:
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ AuthEncAdDataEngine::Overhead };
+
+    typedef Nonce<Operation::AuthEncAdData, NonceSequentialSize>	NonceType;
+    typedef SecretKeyBase<AuthEncAdDataEngine::SecretKeySize>		SecretKeyBaseType;
+
+    NonceType&						nonce;
+    const Operation					oper;
+
+    AuthEncAdDataEngineSealer(const SecretKeyBaseType& sk_, NonceType& n_, Operation oper_ = AuthEncAdDataEngine::fastest())
+	: nonce		{ n_ }
+	, oper		{ oper_ }
+	, _id		{ AuthEncAdDataEngine::id(oper_) }
+    {
+	if(!AuthEncAdDataEngine::available(oper))
+	    throw Exception(Exception::FormatMsg);
+	if(oper == Operation::AuthEncAdDataAes256Gcm)
+	    _gcm.reset(new AuthEncAdDataSealer<Operation::AuthEncAdDataAes256Gcm, S>(sk_, _gcmNonce));
+	else
+	    _chacha.reset(new AuthEncAdDataSealer<Operation::AuthEncAdData, S>(sk_, nonce));
+    }
+    AuthEncAdDataEngineSealer(const AuthEncAdDataEngineSealer&) = delete;
+    AuthEncAdDataEngineSealer(AuthEncAdDataEngineSealer&&) = delete;
+
+    AuthEncAdDataEngineSealer& operator = (const AuthEncAdDataEngineSealer&) = delete;
+    AuthEncAdDataEngineSealer& operator = (AuthEncAdDataEngineSealer&&) = delete;
+
+    std::string operator () (const std::string& message_)
+    {
+	return operator()(message_, std::string());
+    }
+    std::string operator () (const std::string& message_, const std::string& data_)
+    {
+	std::string result(message_.length() + Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
+		   reinterpret_cast<const unsigned char*>(&data_[0]), data_.length(), reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	return operator()(mP_, mN_, nullptr, 0, cP_, cN_);
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	*cP_= _id;
+	if(_gcm)
+	    (*_gcm)(GcmNonceType(nonce.begin(), nonce.end()), mP_, mN_, dP_, dN_, cP_ + AuthEncAdDataEngine::HeaderSize);
+	else
+	    (*_chacha)(nonce, mP_, mN_, dP_, dN_, cP_ + AuthEncAdDataEngine::HeaderSize);
+	++nonce;
+	return mN_ + Overhead;
+    }
+
+private:
+    typedef Nonce<Operation::AuthEncAdDataAes256Gcm, NonceSequentialSize>	GcmNonceType;
+
+    const unsigned char					_id;
+    GcmNonceType					_gcmNonce;
+    std::unique_ptr<AuthEncAdDataSealer<Operation::AuthEncAdDataAes256Gcm, S>>	_gcm;
+    std::unique_ptr<AuthEncAdDataSealer<Operation::AuthEncAdData, S>>		_chacha;
+};
+
+/*
+ * AuthEncAdDataEngineOpener. Opens AuthEncAdDataEngineSealer cyphers of either Operation, AES256-GCM
+ * ones only where the CPU supports it.
+ */
+template <std::size_t S = OperationTraits<Operation::AuthEncAdData>::NonceDefaultSequentialSize> class AuthEncAdDataEngineOpener {
+public:
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ AuthEncAdDataEngine::Overhead };
+
+    typedef Nonce<Operation::AuthEncAdData, NonceSequentialSize>	NonceType;
+    typedef SecretKeyBase<AuthEncAdDataEngine::SecretKeySize>		SecretKeyBaseType;
+
+    NonceType&						nonce;
+
+    AuthEncAdDataEngineOpener(const SecretKeyBaseType& sk_, NonceType& n_)
+	: nonce		{ n_ }
+	, _chacha	{ sk_, _chachaNonce }
+    {
+	if(AuthEncAdDataEngine::available(Operation::AuthEncAdDataAes256Gcm))
+	    _gcm.reset(new AuthEncAdDataOpener<Operation::AuthEncAdDataAes256Gcm, S>(sk_, _gcmNonce));
+    }
+    AuthEncAdDataEngineOpener(const AuthEncAdDataEngineOpener&) = delete;
+    AuthEncAdDataEngineOpener(AuthEncAdDataEngineOpener&&) = delete;
+
+    AuthEncAdDataEngineOpener& operator = (const AuthEncAdDataEngineOpener&) = delete;
+    AuthEncAdDataEngineOpener& operator = (AuthEncAdDataEngineOpener&&) = delete;
+
+    std::string operator () (const std::string& cypher_)
+    {
+	return operator()(cypher_, std::string());
+    }
+    std::string operator () (const std::string& cypher_, const std::string& data_)
+    {
+	if(cypher_.length() < Overhead)
+	    throw VerificationError();
+	std::string result(cypher_.length() - Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&cypher_[0]), cypher_.length(),
+		   reinterpret_cast<const unsigned char*>(&data_[0]), data_.length(), reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	return operator()(cP_, cN_, nullptr, 0, mP_, mN_);
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* mP_, std::size_t mN_)
+    {
+	if(cN_ < Overhead)
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+	bool verified;
+	switch(AuthEncAdDataEngine::oper(*cP_)) {
+	case Operation::AuthEncAdDataAes256Gcm:
+	    if(!_gcm)
+		throw Exception(Exception::FormatMsg);
+	    verified= (*_gcm)(GcmNonceType(nonce.begin(), nonce.end()), cP_ + AuthEncAdDataEngine::HeaderSize,
+			      cN_ - AuthEncAdDataEngine::HeaderSize, dP_, dN_, mP_, std::nothrow);
+	    break;
+	default:
+	    verified= _chacha(nonce, cP_ + AuthEncAdDataEngine::HeaderSize, cN_ - AuthEncAdDataEngine::HeaderSize, dP_, dN_, mP_,
+			      std::nothrow);
+	}
+	if(!verified)
+	    throw VerificationError();
+	++nonce;
+	return cN_ - Overhead;
+    }
+
+private:
+    typedef Nonce<Operation::AuthEncAdDataAes256Gcm, NonceSequentialSize>	GcmNonceType;
+
+    NonceType						_chachaNonce;
+    GcmNonceType					_gcmNonce;
+    AuthEncAdDataOpener<Operation::AuthEncAdData, S>	_chacha;
+    std::unique_ptr<AuthEncAdDataOpener<Operation::AuthEncAdDataAes256Gcm, S>>	_gcm;
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOAUTHENCADDATAENGINE_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -30,6 +30,8 @@
 #include <sodium/crypto_auth_hmacsha512256.h>
 #include <sodium/crypto_onetimeauth_poly1305.h>
 
+#include <vector>
+
 #include "CryptoSecretKey.h"
 
 namespace Crypto {
@@ -197,6 +199,16 @@ public:
 	{
 	    return operator()(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length());
 	}
+	Builder& operator () (const Segment* begin_, const Segment* end_) noexcept
+	{
+	    for(auto i { begin_ }; i != end_; ++i)
+		operator()(i->pointer, i->length);
+	    return *this;
+	}
+	Builder& operator () (const std::vector<Segment>& segments_) noexcept
+	{
+	    return operator()(segments_.data(), segments_.data() + segments_.size());
+	}
     };
 
     Authenticator() noexcept = default;
@@ -224,6 +236,12 @@ public:
     Authenticator(const SecretKeyBaseType& sk_, const std::string& message_) noexcept
 	: Authenticator<Oper>(sk_, reinterpret_cast<const unsigned char *>(&message_[0]), message_.length())
     {}
+    Authenticator(const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(begin_, end_))
+    {}
+    Authenticator(const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(message_))
+    {}
 
     void operator () (const SecretKeyBaseType& sk_, const unsigned char* p_, std::size_t n_) const
     {
@@ -238,6 +256,15 @@ public:
     {
 	operator()(sk_, reinterpret_cast<const unsigned char*>(&message_[0]), message_.length());
     }
+    void operator () (const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) const
+    {
+	if(::sodium_memcmp(AuthenticatorBase<Size>::begin(), Authenticator<Oper>(sk_, begin_, end_).begin(), Size))
+	    throw VerificationError();
+    }
+    void operator () (const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) const
+    {
+	operator()(sk_, message_.data(), message_.data() + message_.size());
+    }
 };
 
 template <> class Authenticator<Operation::AuthHmacSha512>
@@ -273,6 +300,16 @@ public:
 	{
 	    return operator()(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length());
 	}
+	Builder& operator () (const Segment* begin_, const Segment* end_) noexcept
+	{
+	    for(auto i { begin_ }; i != end_; ++i)
+		operator()(i->pointer, i->length);
+	    return *this;
+	}
+	Builder& operator () (const std::vector<Segment>& segments_) noexcept
+	{
+	    return operator()(segments_.data(), segments_.data() + segments_.size());
+	}
     };
 
     Authenticator() noexcept = default;
@@ -300,6 +337,12 @@ public:
     Authenticator(const SecretKeyBaseType& sk_, const std::string& message_) noexcept
 	: Authenticator<Oper>(sk_, reinterpret_cast<const unsigned char *>(&message_[0]), message_.length())
     {}
+    Authenticator(const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(begin_, end_))
+    {}
+    Authenticator(const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(message_))
+    {}
 
     void operator () (const SecretKeyBaseType& sk_, const unsigned char* p_, std::size_t n_) const
     {
@@ -314,6 +357,15 @@ public:
     {
 	operator()(sk_, reinterpret_cast<const unsigned char*>(&message_[0]), message_.length());
     }
+    void operator () (const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) const
+    {
+	if(::sodium_memcmp(AuthenticatorBase<Size>::begin(), Authenticator<Oper>(sk_, begin_, end_).begin(), Size))
+	    throw VerificationError();
+    }
+    void operator () (const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) const
+    {
+	operator()(sk_, message_.data(), message_.data() + message_.size());
+    }
 };
 
 template <> class Authenticator<Operation::AuthHmacSha512256>
@@ -349,6 +401,16 @@ public:
 	{
 	    return operator()(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length());
 	}
+	Builder& operator () (const Segment* begin_, const Segment* end_) noexcept
+	{
+	    for(auto i { begin_ }; i != end_; ++i)
+		operator()(i->pointer, i->length);
+	    return *this;
+	}
+	Builder& operator () (const std::vector<Segment>& segments_) noexcept
+	{
+	    return operator()(segments_.data(), segments_.data() + segments_.size());
+	}
     };
 
     Authenticator() noexcept = default;
@@ -376,6 +438,12 @@ public:
     Authenticator(const SecretKeyBaseType& sk_, const std::string& message_) noexcept
 	: Authenticator<Oper>(sk_, reinterpret_cast<const unsigned char *>(&message_[0]), message_.length())
     {}
+    Authenticator(const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(begin_, end_))
+    {}
+    Authenticator(const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(message_))
+    {}
 
     void operator () (const SecretKeyBaseType& sk_, const unsigned char* p_, std::size_t n_) const
     {
@@ -390,6 +458,15 @@ public:
     {
 	operator()(sk_, reinterpret_cast<const unsigned char*>(&message_[0]), message_.length());
     }
+    void operator () (const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) const
+    {
+	if(::sodium_memcmp(AuthenticatorBase<Size>::begin(), Authenticator<Oper>(sk_, begin_, end_).begin(), Size))
+	    throw VerificationError();
+    }
+    void operator () (const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) const
+    {
+	operator()(sk_, message_.data(), message_.data() + message_.size());
+    }
 };
 
 template <> class Authenticator<Operation::OneTimeAuthPoly1305>
@@ -425,6 +502,16 @@ public:
 	{
 	    return operator()(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length());
 	}
+	Builder& operator () (const Segment* begin_, const Segment* end_) noexcept
+	{
+	    for(auto i { begin_ }; i != end_; ++i)
+		operator()(i->pointer, i->length);
+	    return *this;
+	}
+	Builder& operator () (const std::vector<Segment>& segments_) noexcept
+	{
+	    return operator()(segments_.data(), segments_.data() + segments_.size());
+	}
     };
 
     Authenticator() noexcept = default;
@@ -452,6 +539,12 @@ public:
     Authenticator(const SecretKeyBaseType& sk_, const std::string& message_) noexcept
 	: Authenticator<Oper>(sk_, reinterpret_cast<const unsigned char *>(&message_[0]), message_.length())
     {}
+    Authenticator(const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(begin_, end_))
+    {}
+    Authenticator(const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) noexcept
+	: Authenticator<Oper>(Builder(sk_)(message_))
+    {}
 
     void operator () (const SecretKeyBaseType& sk_, const unsigned char* p_, std::size_t n_) const
     {
@@ -466,6 +559,15 @@ public:
     {
 	operator()(sk_, reinterpret_cast<const unsigned char*>(&message_[0]), message_.length());
     }
+    void operator () (const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_) const
+    {
+	if(::sodium_memcmp(AuthenticatorBase<Size>::begin(), Authenticator<Oper>(sk_, begin_, end_).begin(), Size))
+	    throw VerificationError();
+    }
+    void operator () (const SecretKeyBaseType& sk_, const std::vector<Segment>& message_) const
+    {
+	operator()(sk_, message_.data(), message_.data() + message_.size());
+    }
 };
 
 } // namespace Crypto
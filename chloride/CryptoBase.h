@@ -29,6 +29,10 @@
 #if (SODIUM_LIBRARY_VERSION_MAJOR) < 7 || ((SODIUM_LIBRARY_VERSION_MAJOR) == 7 && (SODIUM_LIBRARY_VERSION_MINOR) < 6)
 #error Chloride needs libsodium >= 7.6
 #endif
+#define CHLORIDE_SODIUM_LIBRARY_VERSION(major, minor)	((SODIUM_LIBRARY_VERSION_MAJOR) > (major) \
+							 || ((SODIUM_LIBRARY_VERSION_MAJOR) == (major) && (SODIUM_LIBRARY_VERSION_MINOR) >= (minor)))
+#define CHLORIDE_HAS_AEAD_DETACHED			CHLORIDE_SODIUM_LIBRARY_VERSION(9, 2)
+#define CHLORIDE_HAS_AEAD_XCHACHA20POLY1305		CHLORIDE_SODIUM_LIBRARY_VERSION(9, 4)
 
 #include "version.h"
 #define CHLORIDE_QUOTE(name)		#name
@@ -76,8 +80,39 @@ constexpr struct GenerateTag {}		Generate		{};
 constexpr struct GenerateConstantTag {}	GenerateConstant	{};
 constexpr struct SpecifyConstantTag {}	SpecifyConstant		{};
 constexpr struct SealerTag {}		Sealer			{};
+constexpr struct HeadroomTag {}		Headroom		{};
+constexpr struct DetachedTag {}		Detached		{};
+constexpr struct TailroomTag {}		Tailroom		{};
 } // namespace Tag
 
+/*
+ * Constant memory segment.
+ */
+struct Segment {
+    const unsigned char*				pointer;
+    std::size_t						length;
+
+    Segment() noexcept
+	: pointer	{ nullptr }
+	, length	{ 0 }
+    {}
+    Segment(const unsigned char* p_, std::size_t n_) noexcept
+	: pointer	{ p_ }
+	, length	{ n_ }
+    {}
+    Segment(const unsigned char* begin_, const unsigned char* end_) noexcept
+	: pointer	{ begin_ }
+	, length	{ static_cast<std::size_t>(end_ - begin_) }
+    {}
+    Segment(const std::string& s_) noexcept
+	: pointer	{ reinterpret_cast<const unsigned char*>(s_.data()) }
+	, length	{ s_.length() }
+    {}
+
+    const unsigned char* begin() const noexcept			{ return pointer; }
+    const unsigned char* end() const noexcept			{ return pointer + length; }
+};
+
 /*
  * Supported cryptographic operations.
  */
@@ -96,7 +131,8 @@ enum class Operation {
 	StreamChacha20, StreamXsalsa20,					Stream =		StreamXsalsa20,
     DiffieHellmanCurve25519,						DiffieHellman =		DiffieHellmanCurve25519,
     AuthEncAdDataAes256Gcm, AuthEncAdDataChacha20Poly1305,
-	AuthEncAdDataChacha20Poly1305Ietf,				AuthEncAdData =		AuthEncAdDataChacha20Poly1305Ietf
+	AuthEncAdDataChacha20Poly1305Ietf,				AuthEncAdData =		AuthEncAdDataChacha20Poly1305Ietf,
+    AuthEncAdDataXChacha20Poly1305Ietf
 };
 
 /*
@@ -0,0 +1,260 @@
+/*
+** CryptoBatch.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHLORIDE_CRYPTOBATCH_H_
+#define CHLORIDE_CRYPTOBATCH_H_
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "CryptoMemory.h"
+#include "CryptoThreadPool.h"
+
+namespace Crypto {
+/*
+ * Batch. Seals or opens a list of messages with any BoxSealer/BoxOpener or AuthEncAdDataSealer/Opener,
+ * one Nonce increment per message, into a single Memory::Alignment aligned arena. The arena and
+ * the entry table are reused by the next batch and only grow when a batch doesn't fit.
+ * The ThreadPool variant of open opens message i with its own opener, which may be shared by
+ * several messages from the same sender: each message takes the next Nonce of its opener in list
+ * order, verified or not, and a message that fails to verify leaves an empty entry and a cleared
+ * verified bit instead of throwing. The std::nothrow and ThreadPool variants with a single opener
+ * behave the same for a list of messages from one sender: message i is opened under the opener's
+ * Nonce plus i and the Nonce moves past the whole list, so forgeries cost no exception unwinding.
+ */
+class Batch {
+public:
+    struct Entry {
+	std::size_t					offset;
+	std::size_t					length;
+    };
+
+    Batch() noexcept
+	: _capacity	{ 0 }
+	, _size		{ 0 }
+    {}
+    explicit Batch(std::size_t capacity_, std::size_t entries_ = 0)
+	: Batch()
+    {
+	reserve(capacity_, entries_);
+    }
+    Batch(const Batch&) = delete;
+    Batch(Batch&&) = delete;
+
+    Batch& operator = (const Batch&) = delete;
+    Batch& operator = (Batch&&) = delete;
+
+    template <typename S> Batch& seal(S& sealer_, const Segment* begin_, const Segment* end_)
+    {
+	std::size_t size { 0 };
+	for(auto i { begin_ }; i != end_; ++i)
+	    size+= i->length + S::Overhead;
+	_prepare(static_cast<std::size_t>(end_ - begin_), size);
+	for(auto i { begin_ }; i != end_; ++i)
+	    _append(sealer_(i->pointer, i->length, _arena.get() + _size, i->length + S::Overhead));
+	return *this;
+    }
+    template <typename S> Batch& seal(S& sealer_, const std::vector<Segment>& messages_)
+    {
+	return seal(sealer_, messages_.data(), messages_.data() + messages_.size());
+    }
+
+    template <typename O> Batch& open(O& opener_, const Segment* begin_, const Segment* end_)
+    {
+	std::size_t size { 0 };
+	for(auto i { begin_ }; i != end_; ++i)
+	    size+= i->length > O::Overhead ? i->length - O::Overhead : 0;
+	_prepare(static_cast<std::size_t>(end_ - begin_), size);
+	for(auto i { begin_ }; i != end_; ++i)
+	    _append(opener_(i->pointer, i->length, _arena.get() + _size, _capacity - _size));
+	return *this;
+    }
+    template <typename O> Batch& open(O& opener_, const std::vector<Segment>& cyphers_)
+    {
+	return open(opener_, cyphers_.data(), cyphers_.data() + cyphers_.size());
+    }
+    template <typename O> Batch& open(O& opener_, const Segment* begin_, const Segment* end_, std::nothrow_t)
+    {
+	const typename O::NonceType first { _layout<O>(begin_, end_, opener_.nonce) };
+	for(std::size_t i { 0 }, n { _entries.size() }; i != n; ++i)
+	    if(opener_(first + i, begin_[i].pointer, begin_[i].length, _arena.get() + _entries[i].offset, std::nothrow))
+		_verify(i, begin_[i].length - O::Overhead);
+	return *this;
+    }
+    template <typename O> Batch& open(O& opener_, const std::vector<Segment>& cyphers_, std::nothrow_t)
+    {
+	return open(opener_, cyphers_.data(), cyphers_.data() + cyphers_.size(), std::nothrow);
+    }
+    template <typename O> Batch& open(O& opener_, ThreadPool& pool_, const Segment* begin_, const Segment* end_,
+				      std::size_t grain_ = Word)
+    {
+	const typename O::NonceType first { _layout<O>(begin_, end_, opener_.nonce) };
+	pool_(_entries.size(), _grain(grain_), [&](std::size_t b_, std::size_t e_) {
+	    for(std::size_t i { b_ }; i != e_; ++i)
+		if(opener_(first + i, begin_[i].pointer, begin_[i].length, _arena.get() + _entries[i].offset, std::nothrow))
+		    _verify(i, begin_[i].length - O::Overhead);
+	});
+	return *this;
+    }
+    template <typename O> Batch& open(O& opener_, ThreadPool& pool_, const std::vector<Segment>& cyphers_, std::size_t grain_ = Word)
+    {
+	return open(opener_, pool_, cyphers_.data(), cyphers_.data() + cyphers_.size(), grain_);
+    }
+    template <typename O> Batch& open(ThreadPool& pool_, O* const* openers_, const Segment* begin_, const Segment* end_,
+				      std::size_t grain_ = Word)
+    {
+	const std::size_t entries { static_cast<std::size_t>(end_ - begin_) };
+	// Reserve every Nonce on copies first, so an overflow leaves all openers and the batch alone.
+	std::vector<typename O::NonceType> nonces(entries);
+	std::unordered_map<O*, typename O::NonceType> next;
+	for(std::size_t i { 0 }; i != entries; ++i)
+	{
+	    auto& n { next.emplace(openers_[i], openers_[i]->nonce).first->second };
+	    nonces[i]= n;
+	    ++n;
+	}
+	_layout<O>(begin_, end_);
+	for(auto& n : next)
+	    n.first->nonce= n.second;
+	pool_(entries, _grain(grain_), [&](std::size_t b_, std::size_t e_) {
+	    for(std::size_t i { b_ }; i != e_; ++i)
+		if((*openers_[i])(nonces[i], begin_[i].pointer, begin_[i].length, _arena.get() + _entries[i].offset, std::nothrow))
+		    _verify(i, begin_[i].length - O::Overhead);
+	});
+	return *this;
+    }
+    template <typename O> Batch& open(ThreadPool& pool_, const std::vector<O*>& openers_, const std::vector<Segment>& cyphers_,
+				      std::size_t grain_ = Word)
+    {
+	if(openers_.size() != cyphers_.size())
+	    throw Exception(Exception::SizeMsg);
+	return open(pool_, openers_.data(), cyphers_.data(), cyphers_.data() + cyphers_.size(), grain_);
+    }
+
+    Segment operator [] (std::size_t i_) const noexcept
+    {
+	return Segment(_arena.get() + _entries[i_].offset, _entries[i_].length);
+    }
+
+    const unsigned char* begin() const noexcept			{ return _arena.get(); }
+    const unsigned char* end() const noexcept			{ return _arena.get() + _size; }
+
+    std::size_t size() const noexcept				{ return _size; }
+    std::size_t capacity() const noexcept			{ return _capacity; }
+    const std::vector<Entry>& entries() const noexcept		{ return _entries; }
+
+    bool verified(std::size_t i_) const noexcept		{ return (_verified[i_ / Word] >> (i_ % Word)) & 1; }
+    std::size_t verifiedCount() const noexcept
+    {
+	std::size_t result { 0 };
+	for(auto w : _verified)
+	    result+= std::bitset<Word>(w).count();
+	return result;
+    }
+    const std::vector<std::uint64_t>& verified() const noexcept	{ return _verified; }
+
+    void reserve(std::size_t capacity_, std::size_t entries_ = 0)
+    {
+	if(capacity_ > _capacity)
+	{
+	    const std::size_t capacity { ((capacity_ + Memory::Alignment - 1) >> Memory::AlignmentShift) << Memory::AlignmentShift };
+	    std::unique_ptr<unsigned char[], Memory::Free> arena { new(Memory::Allocate) unsigned char[capacity] };
+	    _arena.swap(arena);
+	    _capacity= capacity;
+	    _size= 0;
+	    _entries.clear();
+	}
+	_entries.reserve(entries_);
+    }
+
+    void clear() noexcept
+    {
+	_size= 0;
+	_entries.clear();
+	_verified.clear();
+    }
+
+private:
+    constexpr static std::size_t			Word		{ 64 };
+
+    std::unique_ptr<unsigned char[], Memory::Free>	_arena;
+    std::size_t						_capacity;
+    std::size_t						_size;
+    std::vector<Entry>					_entries;
+    std::vector<std::uint64_t>				_verified;
+
+    void _prepare(std::size_t entries_, std::size_t size_)
+    {
+	clear();
+	reserve(size_ > _capacity ? std::max(size_, 2 * _capacity) : 0, entries_);
+	_verified.assign((entries_ + Word - 1) / Word, 0);
+    }
+    // Lay out an empty entry per cypher with room for its message, all unverified.
+    template <typename O> void _layout(const Segment* begin_, const Segment* end_)
+    {
+	std::size_t size { 0 };
+	for(auto i { begin_ }; i != end_; ++i)
+	    size+= i->length > O::Overhead ? i->length - O::Overhead : 0;
+	_prepare(static_cast<std::size_t>(end_ - begin_), size);
+	for(auto i { begin_ }; i != end_; ++i)
+	{
+	    _entries.push_back(Entry { _size, 0 });
+	    _size+= i->length > O::Overhead ? i->length - O::Overhead : 0;
+	}
+    }
+    // As above, and reserve a Nonce per cypher: returns the first, throws before opening anything on overflow.
+    template <typename O> typename O::NonceType _layout(const Segment* begin_, const Segment* end_, typename O::NonceType& nonce_)
+    {
+	_layout<O>(begin_, end_);
+	const typename O::NonceType result { nonce_ };
+	nonce_+= _entries.size();
+	return result;
+    }
+    // Grains of whole bitmap words so no two threads share a word.
+    static std::size_t _grain(std::size_t grain_) noexcept
+    {
+	return (std::max<std::size_t>(grain_, 1) + Word - 1) / Word * Word;
+    }
+    void _verify(std::size_t i_, std::size_t length_) noexcept
+    {
+	_entries[i_].length= length_;
+	_verified[i_ / Word]|= std::uint64_t { 1 } << (i_ % Word);
+    }
+    void _append(std::size_t length_)
+    {
+	_verified[_entries.size() / Word]|= std::uint64_t { 1 } << (_entries.size() % Word);
+	_entries.push_back(Entry { _size, length_ });
+	_size+= length_;
+    }
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOBATCH_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -27,9 +27,23 @@
 
 #include <sodium/crypto_box_curve25519xsalsa20poly1305.h>
 #include <sodium/crypto_secretbox_xsalsa20poly1305.h>
-
+#include <sodium/crypto_box.h>
+#include <sodium/crypto_secretbox.h>
+#include <sodium/crypto_generichash_blake2b.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "CryptoAuthenticate.h"
 #include "CryptoPublicKey.h"
 #include "CryptoNonce.h"
+#include "CryptoMemory.h"
 
 namespace Crypto {
 /*
@@ -86,7 +100,214 @@ template <> struct OperationTraits<Operation::SecretBoxXsalsa20Poly1305> {
 };
 
 /*
- * BoxSealer.
+ * BoxAuthenticator. The Poly1305 authenticator of a detached Box or SecretBox.
+ */
+template <Operation O> class BoxAuthenticator
+	: public AuthenticatorBase<OperationTraits<O>::ClearPadSize - OperationTraits<O>::CypherPadSize> {
+    static_assert(OperationTraits<O>::HasBox || OperationTraits<O>::HasSecretBox, "Illegal BoxAuthenticator type!");
+public:
+    constexpr static Operation				Oper		{ O };
+    constexpr static std::size_t			Size		{ OperationTraits<Oper>::ClearPadSize - OperationTraits<Oper>::CypherPadSize };
+
+    BoxAuthenticator() noexcept = default;
+    explicit BoxAuthenticator(const unsigned char* raw_) noexcept
+	: AuthenticatorBase<Size>(raw_)
+    {}
+    template <typename I> BoxAuthenticator(I begin_, I end_)
+	: AuthenticatorBase<Size>(begin_, end_)
+    {}
+    explicit BoxAuthenticator(const std::string& s_)
+	: AuthenticatorBase<Size>(s_.begin(), s_.end())
+    {}
+};
+
+/*
+ * BoxKeyCache. Bounded least recently used cache of precomputed Box keys indexed by (our SecretKey,
+ * their PublicKey). All keys live in one locked region, keys are only evicted when no BoxSealer or
+ * BoxOpener holds them and the cache must outlive those. Thread safe.
+ */
+template <Operation O> class BoxKeyCache {
+    static_assert(OperationTraits<O>::HasBox, "Illegal BoxKeyCache type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			Size			{ OperationTraits<Oper>::IntermediateSize };
+    constexpr static std::size_t			IndexSize		{ crypto_generichash_blake2b_BYTES };
+
+    typedef PublicKey<Oper>					PublicKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    class Handle {
+	friend class BoxKeyCache;
+    public:
+	Handle() noexcept
+	    : _cache	{ nullptr }
+	    , _slot	{ 0 }
+	{}
+	Handle(Handle&& h_) noexcept
+	    : _cache	{ h_._cache }
+	    , _slot	{ h_._slot }
+	{
+	    h_._cache= nullptr;
+	}
+	Handle(const Handle&) = delete;
+	~Handle() noexcept					{ release(); }
+
+	Handle& operator = (Handle&& h_) noexcept
+	{
+	    release();
+	    _cache= h_._cache;
+	    _slot= h_._slot;
+	    h_._cache= nullptr;
+	    return *this;
+	}
+	Handle& operator = (const Handle&) = delete;
+
+	explicit operator bool () const noexcept		{ return _cache != nullptr; }
+
+	const unsigned char* begin() const noexcept		{ return _cache->_keys.get() + _slot * Size; }
+	const unsigned char* end() const noexcept		{ return begin() + Size; }
+
+	void release() noexcept
+	{
+	    if(_cache)
+		_cache->_release(_slot);
+	    _cache= nullptr;
+	}
+
+    private:
+	BoxKeyCache*					_cache;
+	std::size_t					_slot;
+
+	Handle(BoxKeyCache* c_, std::size_t s_) noexcept
+	    : _cache	{ c_ }
+	    , _slot	{ s_ }
+	{}
+    };
+
+    explicit BoxKeyCache(std::size_t capacity_)
+	: _capacity	{ capacity_ }
+	, _keys		{ new(Memory::Allocate) unsigned char[capacity_ * Size] }
+	, _slots	(capacity_)
+	, _hits		{ 0 }
+	, _misses	{ 0 }
+    {
+	::randombytes_buf(_indexKey, sizeof(_indexKey));
+	_index.reserve(_capacity);
+	for(std::size_t i { _capacity }; i != 0; --i)
+	    _free.push_back(i - 1);
+    }
+    BoxKeyCache(const BoxKeyCache&) = delete;
+    BoxKeyCache(BoxKeyCache&&) = delete;
+    ~BoxKeyCache() noexcept					{ ::sodium_memzero(_indexKey, sizeof(_indexKey)); }
+
+    BoxKeyCache& operator = (const BoxKeyCache&) = delete;
+    BoxKeyCache& operator = (BoxKeyCache&&) = delete;
+
+    /*
+     * Returns an empty Handle when every key is in use, callers then compute their own.
+     */
+    Handle operator () (const PublicKeyType& pk_, const SecretKeyBaseType& sk_)
+    {
+	IndexType index;
+	::crypto_generichash_blake2b_state state;
+	::crypto_generichash_blake2b_init(&state, _indexKey, sizeof(_indexKey), IndexSize);
+	::crypto_generichash_blake2b_update(&state, sk_.begin(), sk_.Size);
+	::crypto_generichash_blake2b_update(&state, pk_.begin(), pk_.Size);
+	::crypto_generichash_blake2b_final(&state, index.data(), IndexSize);
+
+	std::unique_lock<std::mutex> lock { _mutex };
+	const auto i { _index.find(index) };
+	if(i != _index.end())
+	{
+	    Slot& slot { _slots[i->second] };
+	    ++slot.pins;
+	    _recent.splice(_recent.begin(), _recent, slot.recent);
+	    _ready.wait(lock, [&slot]() { return slot.ready; });
+	    _hits.fetch_add(1, std::memory_order_relaxed);
+	    return Handle(this, i->second);
+	}
+	_misses.fetch_add(1, std::memory_order_relaxed);
+	std::size_t s;
+	if(!_free.empty())
+	{
+	    s= _free.back();
+	    _free.pop_back();
+	    _recent.push_front(s);
+	}
+	else
+	{
+	    auto j { _recent.end() };
+	    while(j != _recent.begin() && _slots[*std::prev(j)].pins > 0)
+		--j;
+	    if(j == _recent.begin())
+		return Handle();
+	    s= *--j;
+	    _index.erase(_slots[s].index);
+	    _recent.splice(_recent.begin(), _recent, j);
+	}
+	Slot& slot { _slots[s] };
+	slot.index= index;
+	slot.pins= 1;
+	slot.ready= false;
+	slot.recent= _recent.begin();
+	_index.emplace(index, s);
+	lock.unlock();
+	::crypto_box_curve25519xsalsa20poly1305_beforenm(_keys.get() + s * Size, pk_.begin(), sk_.begin());
+	lock.lock();
+	slot.ready= true;
+	lock.unlock();
+	_ready.notify_all();
+	return Handle(this, s);
+    }
+
+    std::size_t capacity() const noexcept			{ return _capacity; }
+    std::size_t hits() const noexcept				{ return _hits.load(std::memory_order_relaxed); }
+    std::size_t misses() const noexcept				{ return _misses.load(std::memory_order_relaxed); }
+
+private:
+    typedef std::array<unsigned char, IndexSize>		IndexType;
+
+    struct IndexHash {
+	std::size_t operator () (const IndexType& i_) const noexcept
+	{
+	    std::size_t result;
+	    std::memcpy(&result, i_.data(), sizeof(result));
+	    return result;
+	}
+    };
+
+    struct Slot {
+	IndexType					index;
+	std::size_t					pins;
+	bool						ready;
+	std::list<std::size_t>::iterator		recent;
+    };
+
+    const std::size_t					_capacity;
+    std::unique_ptr<unsigned char[], Memory::Free>	_keys;
+    std::vector<Slot>					_slots;
+    std::vector<std::size_t>				_free;
+    std::list<std::size_t>				_recent;
+    std::unordered_map<IndexType, std::size_t, IndexHash>
+							_index;
+    unsigned char					_indexKey[crypto_generichash_blake2b_KEYBYTES];
+    std::mutex						_mutex;
+    std::condition_variable				_ready;
+    std::atomic<std::size_t>				_hits;
+    std::atomic<std::size_t>				_misses;
+
+    void _release(std::size_t s_) noexcept
+    {
+	std::lock_guard<std::mutex> lock { _mutex };
+	--_slots[s_].pins;
+    }
+};
+
+/*
+ * BoxSealer. Caller buffers receive Overhead bytes more than the message, the Headroom variant
+ * seals in place and needs ClearPadSize bytes of headroom in front of the message. The Detached
+ * variant encrypts in place and returns the authenticator separately. Segment lists are
+ * linearized into a reused scratch buffer that is wiped after sealing.
  */
 template <Operation O, std::size_t = OperationTraits<O>::NonceDefaultSequentialSize, typename = void> class BoxSealer {
     static_assert(OperationTraits<O>::HasBox || OperationTraits<O>::HasSecretBox, "Illegal BoxSealer type!");
@@ -99,43 +320,99 @@ public:
     constexpr static std::size_t			Size			{ OperationTraits<Oper>::IntermediateSize };
     constexpr static std::size_t			ClearPadSize		{ OperationTraits<Oper>::ClearPadSize };
     constexpr static std::size_t			CypherPadSize		{ OperationTraits<Oper>::CypherPadSize };
+    constexpr static std::size_t			Overhead		{ ClearPadSize - CypherPadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef PublicKey<Oper>					PublicKeyType;
     typedef KeyPair<Oper>					KeyPairType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef BoxAuthenticator<Oper>				AuthenticatorType;
+    typedef BoxKeyCache<Oper>					KeyCacheType;
 
     NonceType&						nonce;
 
     BoxSealer(const PublicKeyType& pk_, const SecretKeyBaseType& sk_, NonceType& n_)
 	: nonce		{ n_ }
+	, _key		{ _bytes }
     {
-	if(::sodium_mlock(_bytes, Size))
-	    throw Exception(Exception::LockMsg);
-	::crypto_box_curve25519xsalsa20poly1305_beforenm(_bytes, pk_.begin(), sk_.begin());
+	_init(pk_, sk_);
+    }
+    BoxSealer(KeyCacheType& c_, const PublicKeyType& pk_, const SecretKeyBaseType& sk_, NonceType& n_)
+	: nonce		{ n_ }
+	, _handle	{ c_(pk_, sk_) }
+	, _key		{ _handle ? _handle.begin() : _bytes }
+    {
+	if(!_handle)
+	    _init(pk_, sk_);
     }
     BoxSealer(const BoxSealer&) = delete;
     BoxSealer(BoxSealer&&) = delete;
-    ~BoxSealer() noexcept					{ ::sodium_munlock(_bytes, Size); }
+    ~BoxSealer() noexcept
+    {
+	if(!_handle)
+	    ::sodium_munlock(_bytes, Size);
+    }
 
     BoxSealer& operator = (const BoxSealer&) = delete;
     BoxSealer& operator = (BoxSealer&&) = delete;
 
     std::string operator () (const std::string& message_)
     {
-	std::string padded(ClearPadSize, '\0');
-	padded+= message_;
-	std::string result(padded.length(), '\0');
-	::crypto_box_curve25519xsalsa20poly1305_afternm(reinterpret_cast<unsigned char*>(&result[0]),
-							reinterpret_cast<unsigned char*>(&padded[0]),
-							padded.length(), nonce.begin(), _bytes);
+	std::string result(message_.length() + Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::string operator () (const std::vector<Segment>& message_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t n { _scratch(message_.data(), message_.data() + message_.size()) };
+	std::string result(n + Overhead, '\0');
+	operator()(_scratch.begin(), n, reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const Segment* begin_, const Segment* end_, unsigned char* cP_, std::size_t cN_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t n { _scratch(begin_, end_) };
+	return operator()(_scratch.begin(), n, cP_, cN_);
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	::crypto_box_easy_afternm(cP_, mP_, mN_, nonce.begin(), _key);
+	++nonce;
+	return mN_ + Overhead;
+    }
+    unsigned char* operator () (unsigned char* p_, std::size_t n_, Tag::HeadroomTag)
+    {
+	::sodium_memzero(p_, ClearPadSize);
+	::crypto_box_curve25519xsalsa20poly1305_afternm(p_, p_, n_ + ClearPadSize, nonce.begin(), _key);
+	++nonce;
+	return p_ + CypherPadSize;
+    }
+    AuthenticatorType operator () (unsigned char* p_, std::size_t n_, Tag::DetachedTag)
+    {
+	AuthenticatorType result;
+	::crypto_box_detached_afternm(p_, result.begin(), p_, n_, nonce.begin(), _key);
 	++nonce;
-	return result.substr(CypherPadSize);
+	return result;
     }
 
 private:
+    typename KeyCacheType::Handle			_handle;
+    const unsigned char*				_key;
     unsigned char					_bytes[Size];
+    Memory::Scratch					_scratch;
+
+    void _init(const PublicKeyType& pk_, const SecretKeyBaseType& sk_)
+    {
+	if(::sodium_mlock(_bytes, Size))
+	    throw Exception(Exception::LockMsg);
+	::crypto_box_curve25519xsalsa20poly1305_beforenm(_bytes, pk_.begin(), sk_.begin());
+    }
 };
 
 template <Operation O, std::size_t S> class BoxSealer<O, S, typename std::enable_if<OperationTraits<O>::HasSecretBox>::type> {
@@ -144,10 +421,12 @@ public:
     constexpr static std::size_t			NonceSequentialSize	{ S };
     constexpr static std::size_t			ClearPadSize		{ OperationTraits<Oper>::ClearPadSize };
     constexpr static std::size_t			CypherPadSize		{ OperationTraits<Oper>::CypherPadSize };
+    constexpr static std::size_t			Overhead		{ ClearPadSize - CypherPadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef BoxAuthenticator<Oper>				AuthenticatorType;
 
     NonceType&						nonce;
     const SecretKeyBaseType&				secretKey;
@@ -164,19 +443,57 @@ public:
 
     std::string operator () (const std::string& message_)
     {
-	std::string padded(ClearPadSize, '\0');
-	padded+= message_;
-	std::string result(padded.length(), '\0');
-	::crypto_secretbox_xsalsa20poly1305(reinterpret_cast<unsigned char*>(&result[0]),
-					    reinterpret_cast<unsigned char*>(&padded[0]),
-					    padded.length(), nonce.begin(), secretKey.begin());
+	std::string result(message_.length() + Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::string operator () (const std::vector<Segment>& message_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t n { _scratch(message_.data(), message_.data() + message_.size()) };
+	std::string result(n + Overhead, '\0');
+	operator()(_scratch.begin(), n, reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const Segment* begin_, const Segment* end_, unsigned char* cP_, std::size_t cN_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t n { _scratch(begin_, end_) };
+	return operator()(_scratch.begin(), n, cP_, cN_);
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	::crypto_secretbox_easy(cP_, mP_, mN_, nonce.begin(), secretKey.begin());
 	++nonce;
-	return result.substr(CypherPadSize);
+	return mN_ + Overhead;
     }
+    unsigned char* operator () (unsigned char* p_, std::size_t n_, Tag::HeadroomTag)
+    {
+	::sodium_memzero(p_, ClearPadSize);
+	::crypto_secretbox_xsalsa20poly1305(p_, p_, n_ + ClearPadSize, nonce.begin(), secretKey.begin());
+	++nonce;
+	return p_ + CypherPadSize;
+    }
+    AuthenticatorType operator () (unsigned char* p_, std::size_t n_, Tag::DetachedTag)
+    {
+	AuthenticatorType result;
+	::crypto_secretbox_detached(p_, result.begin(), p_, n_, nonce.begin(), secretKey.begin());
+	++nonce;
+	return result;
+    }
+
+private:
+    Memory::Scratch					_scratch;
 };
 
 /*
- * BoxOpener.
+ * BoxOpener. Caller buffers receive Overhead bytes less than the cypher, the Headroom variant
+ * opens in place and needs CypherPadSize bytes of headroom in front of the cypher. The detached
+ * variant decrypts in place after verifying the separate authenticator. The std::nothrow variant
+ * opens with an explicit Nonce, leaves the nonce member alone and returns false on failure.
  */
 template <Operation O, std::size_t = OperationTraits<O>::NonceDefaultSequentialSize, typename = void> class BoxOpener {
     static_assert(OperationTraits<O>::HasBox || OperationTraits<O>::HasSecretBox, "Illegal BoxOpener type!");
@@ -189,44 +506,95 @@ public:
     constexpr static std::size_t			Size			{ OperationTraits<Oper>::IntermediateSize };
     constexpr static std::size_t			ClearPadSize		{ OperationTraits<Oper>::ClearPadSize };
     constexpr static std::size_t			CypherPadSize		{ OperationTraits<Oper>::CypherPadSize };
+    constexpr static std::size_t			Overhead		{ ClearPadSize - CypherPadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef PublicKey<Oper>					PublicKeyType;
     typedef KeyPair<Oper>					KeyPairType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef BoxAuthenticator<Oper>				AuthenticatorType;
+    typedef BoxKeyCache<Oper>					KeyCacheType;
 
     NonceType&						nonce;
 
     BoxOpener(const PublicKeyType& pk_, const SecretKeyBaseType& sk_, NonceType& n_)
 	: nonce		{ n_ }
+	, _key		{ _bytes }
     {
-	if(::sodium_mlock(_bytes, Size))
-	    throw Exception(Exception::LockMsg);
-	::crypto_box_curve25519xsalsa20poly1305_beforenm(_bytes, pk_.begin(), sk_.begin());
+	_init(pk_, sk_);
+    }
+    BoxOpener(KeyCacheType& c_, const PublicKeyType& pk_, const SecretKeyBaseType& sk_, NonceType& n_)
+	: nonce		{ n_ }
+	, _handle	{ c_(pk_, sk_) }
+	, _key		{ _handle ? _handle.begin() : _bytes }
+    {
+	if(!_handle)
+	    _init(pk_, sk_);
     }
     BoxOpener(const BoxOpener&) = delete;
     BoxOpener(BoxOpener&&) = delete;
-    ~BoxOpener() noexcept					{ ::sodium_munlock(_bytes, Size); }
+    ~BoxOpener() noexcept
+    {
+	if(!_handle)
+	    ::sodium_munlock(_bytes, Size);
+    }
 
     BoxOpener& operator = (const BoxOpener&) = delete;
     BoxOpener& operator = (BoxOpener&&) = delete;
 
     std::string operator () (const std::string& cypher_)
     {
-	std::string padded(CypherPadSize, '\0');
-	padded+= cypher_;
-	std::string result(padded.length(), '\0');
-	if(::crypto_box_curve25519xsalsa20poly1305_open_afternm(reinterpret_cast<unsigned char*>(&result[0]),
-								reinterpret_cast<unsigned char*>(&padded[0]),
-								padded.length(), nonce.begin(), _bytes))
+	if(cypher_.length() < Overhead)
+	    throw VerificationError();
+	std::string result(cypher_.length() - Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&cypher_[0]), cypher_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	if(cN_ < Overhead)
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+	if(::crypto_box_open_easy_afternm(mP_, cP_, cN_, nonce.begin(), _key))
+	    throw VerificationError();
+	++nonce;
+	return cN_ - Overhead;
+    }
+    unsigned char* operator () (unsigned char* p_, std::size_t n_, Tag::HeadroomTag)
+    {
+	if(n_ < Overhead)
+	    throw VerificationError();
+	::sodium_memzero(p_, CypherPadSize);
+	if(::crypto_box_curve25519xsalsa20poly1305_open_afternm(p_, p_, n_ + CypherPadSize, nonce.begin(), _key))
+	    throw VerificationError();
+	++nonce;
+	return p_ + ClearPadSize;
+    }
+    void operator () (unsigned char* p_, std::size_t n_, const AuthenticatorType& a_)
+    {
+	if(::crypto_box_open_detached_afternm(p_, p_, a_.begin(), n_, nonce.begin(), _key))
 	    throw VerificationError();
 	++nonce;
-	return result.substr(ClearPadSize);
+    }
+    bool operator () (const NonceType& n_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::nothrow_t) const noexcept
+    {
+	return cN_ >= Overhead && ::crypto_box_open_easy_afternm(mP_, cP_, cN_, n_.begin(), _key) == 0;
     }
 
 private:
+    typename KeyCacheType::Handle			_handle;
+    const unsigned char*				_key;
     unsigned char					_bytes[Size];
+
+    void _init(const PublicKeyType& pk_, const SecretKeyBaseType& sk_)
+    {
+	if(::sodium_mlock(_bytes, Size))
+	    throw Exception(Exception::LockMsg);
+	::crypto_box_curve25519xsalsa20poly1305_beforenm(_bytes, pk_.begin(), sk_.begin());
+    }
 };
 
 template <Operation O, std::size_t S> class BoxOpener<O, S, typename std::enable_if<OperationTraits<O>::HasSecretBox>::type> {
@@ -235,10 +603,12 @@ public:
     constexpr static std::size_t			NonceSequentialSize	{ S };
     constexpr static std::size_t			ClearPadSize		{ OperationTraits<Oper>::ClearPadSize };
     constexpr static std::size_t			CypherPadSize		{ OperationTraits<Oper>::CypherPadSize };
+    constexpr static std::size_t			Overhead		{ ClearPadSize - CypherPadSize };
 
     typedef Nonce<Oper, NonceSequentialSize>			NonceType;
     typedef SecretKey<Oper>					SecretKeyType;
     typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+    typedef BoxAuthenticator<Oper>				AuthenticatorType;
 
     NonceType&						nonce;
     const SecretKeyBaseType&				secretKey;
@@ -255,15 +625,43 @@ public:
 
     std::string operator () (const std::string& cypher_)
     {
-	std::string padded(CypherPadSize, '\0');
-	padded+= cypher_;
-	std::string result(padded.length(), '\0');
-	if(::crypto_secretbox_xsalsa20poly1305_open(reinterpret_cast<unsigned char*>(&result[0]),
-						    reinterpret_cast<unsigned char*>(&padded[0]),
-						    padded.length(), nonce.begin(), secretKey.begin()))
+	if(cypher_.length() < Overhead)
+	    throw VerificationError();
+	std::string result(cypher_.length() - Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&cypher_[0]), cypher_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	if(cN_ < Overhead)
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+	if(::crypto_secretbox_open_easy(mP_, cP_, cN_, nonce.begin(), secretKey.begin()))
+	    throw VerificationError();
+	++nonce;
+	return cN_ - Overhead;
+    }
+    unsigned char* operator () (unsigned char* p_, std::size_t n_, Tag::HeadroomTag)
+    {
+	if(n_ < Overhead)
+	    throw VerificationError();
+	::sodium_memzero(p_, CypherPadSize);
+	if(::crypto_secretbox_xsalsa20poly1305_open(p_, p_, n_ + CypherPadSize, nonce.begin(), secretKey.begin()))
 	    throw VerificationError();
 	++nonce;
-	return result.substr(ClearPadSize);
+	return p_ + ClearPadSize;
+    }
+    void operator () (unsigned char* p_, std::size_t n_, const AuthenticatorType& a_)
+    {
+	if(::crypto_secretbox_open_detached(p_, p_, a_.begin(), n_, nonce.begin(), secretKey.begin()))
+	    throw VerificationError();
+	++nonce;
+    }
+    bool operator () (const NonceType& n_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::nothrow_t) const noexcept
+    {
+	return cN_ >= Overhead && ::crypto_secretbox_open_easy(mP_, cP_, cN_, n_.begin(), secretKey.begin()) == 0;
     }
 };
 
@@ -0,0 +1,597 @@
+/*
+** CryptoChunked.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CHLORIDE_CRYPTOCHUNKED_H_
+#define CHLORIDE_CRYPTOCHUNKED_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <ostream>
+
+#include "CryptoAuthEncAdData.h"
+#include "CryptoBox.h"
+#include "CryptoHash.h"
+#include "CryptoThreadPool.h"
+
+namespace Crypto {
+/*
+ * Chunked SecretBox format. A HeaderSize byte header (the Magic bytes, the Nonce sequential size,
+ * the little endian 32 bit chunk size and the Nonce constant part) followed by chunks of chunk size
+ * bytes sealed independently, the last one may be shorter and an empty blob has one empty chunk.
+ * Chunk i is sealed with the Nonce constant part and sequential part i, the final chunk also with
+ * the Nonce flag set, so truncated, extended and reordered blobs don't verify.
+ */
+namespace Chunked {
+constexpr unsigned char		Magic[]		{ 'C', 'h', 'K' };
+constexpr std::size_t		DefaultChunkSize{ 0x10000 };
+constexpr std::size_t		MaximumChunkSize{ 0x1000000 };
+
+template <typename N> constexpr std::size_t headerSize() noexcept	{ return sizeof(Magic) + 1 + 4 + N::ConstantSize; }
+
+/*
+ * Chunked AuthEncAdData format. The same layout with AuthEncAdDataMagic and a random SaltSize byte
+ * salt in front of the Nonce constant part. Chunks are sealed under the subkey BLAKE2b(key, salt),
+ * so no two streams share a key and Nonce however short the AuthEncAdData Nonce constant part is.
+ * Every chunk also carries associated data: the header, the little endian 64 bit chunk index and
+ * the final chunk flag byte.
+ */
+constexpr unsigned char		AuthEncAdDataMagic[]	{ 'C', 'h', 'A' };
+constexpr std::size_t		SaltSize		{ 32 };
+
+template <typename N> constexpr std::size_t authEncAdDataHeaderSize() noexcept	{ return headerSize<N>() + SaltSize; }
+template <typename N> constexpr std::size_t dataSize() noexcept	{ return authEncAdDataHeaderSize<N>() + 8 + 1; }
+
+template <std::size_t KS> void subkey(SecretKeyBase<KS>& subkey_, const SecretKeyBase<KS>& key_, const unsigned char* salt_) noexcept
+{
+    SizedHash<Operation::GenericHashBlake2b, KS> hash { key_, salt_, SaltSize };
+    std::copy(hash.begin(), hash.end(), subkey_.begin());
+    hash.clear();
+}
+
+inline void data(unsigned char* p_, const unsigned char* header_, std::size_t headerSize_, std::uint64_t index_, bool last_) noexcept
+{
+    p_= std::copy_n(header_, headerSize_, p_);
+    for(std::size_t i { 0 }; i != 8; ++i)
+	*p_++= static_cast<unsigned char>(index_ >> (8 * i));
+    *p_= last_ ? 1 : 0;
+}
+
+// Write the magic_, Nonce sequential size and chunk size fields of a header, returns where the rest goes.
+template <std::size_t M> unsigned char* writeHeader(unsigned char* p_, const unsigned char (&magic_)[M], std::size_t sequentialSize_,
+						    std::size_t chunkSize_) noexcept
+{
+    p_= std::copy_n(magic_, M, p_);
+    *p_++= static_cast<unsigned char>(sequentialSize_);
+    for(std::size_t i { 0 }; i != 4; ++i)
+	*p_++= static_cast<unsigned char>(chunkSize_ >> (8 * i));
+    return p_;
+}
+// Check those fields of the n_ byte header at p_ and read its chunk size, returns where the rest is.
+template <std::size_t M> const unsigned char* readHeader(const unsigned char* p_, std::size_t n_, std::size_t headerSize_,
+							 const unsigned char (&magic_)[M], std::size_t sequentialSize_,
+							 std::size_t maximumChunkSize_, std::size_t& chunkSize_)
+{
+    if(n_ < headerSize_)
+	throw VerificationError();
+    if(!std::equal(magic_, magic_ + M, p_) || p_[M] != sequentialSize_)
+	throw Exception(Exception::FormatMsg);
+    p_+= M + 1;
+    std::size_t chunkSize { 0 };
+    for(std::size_t i { 0 }; i != 4; ++i)
+	chunkSize|= static_cast<std::size_t>(*p_++) << (8 * i);
+    if(chunkSize == 0 || chunkSize > maximumChunkSize_)
+	throw Exception(Exception::FormatMsg);
+    chunkSize_= chunkSize;
+    return p_;
+}
+
+/*
+ * Steps. What sets one chunked format apart: start writes or reads a blob's header and sets up its
+ * Nonce, seal and open handle a single chunk under its Nonce and may run concurrently.
+ */
+template <Operation O, std::size_t S> class SecretBoxSealStep {
+    static_assert(OperationTraits<O>::HasSecretBox, "Illegal ChunkedSealer type!");
+    static_assert(Nonce<O, S>::ConstantSize >= 16, "ChunkedSealer Nonce constant part too short for a random one per blob!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ BoxSealer<Oper, S>::Overhead };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    constexpr static std::size_t			HeaderSize		{ headerSize<NonceType>() };
+
+    explicit SecretBoxSealStep(const SecretKeyBaseType& sk_) noexcept
+	: _secretKey	{ sk_ }
+    {}
+
+    void start(unsigned char* p_, std::size_t chunkSize_, NonceType& n_)
+    {
+	n_= NonceType(Tag::GenerateConstant);
+	n_(false);
+	std::copy(n_.constantBegin(), n_.constantEnd(), writeHeader(p_, Magic, NonceSequentialSize, chunkSize_));
+    }
+    void seal(const NonceType& n_, std::uint64_t, bool, const unsigned char* mP_, std::size_t mN_, unsigned char* cP_) const noexcept
+    {
+	::crypto_secretbox_easy(cP_, mP_, mN_, n_.begin(), _secretKey.begin());
+    }
+
+private:
+    const SecretKeyBaseType&				_secretKey;
+};
+
+template <Operation O, std::size_t S> class SecretBoxOpenStep {
+    static_assert(OperationTraits<O>::HasSecretBox, "Illegal ChunkedOpener type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ BoxOpener<Oper, S>::Overhead };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    constexpr static std::size_t			HeaderSize		{ headerSize<NonceType>() };
+
+    explicit SecretBoxOpenStep(const SecretKeyBaseType& sk_) noexcept
+	: _secretKey	{ sk_ }
+    {}
+
+    std::size_t start(const unsigned char* p_, std::size_t n_, std::size_t maximumChunkSize_, NonceType& nonce_)
+    {
+	std::size_t chunkSize;
+	p_= readHeader(p_, n_, HeaderSize, Magic, NonceSequentialSize, maximumChunkSize_, chunkSize);
+	nonce_= NonceType(p_, p_ + NonceType::ConstantSize, Tag::SpecifyConstant);
+	return chunkSize;
+    }
+    bool open(const NonceType& n_, std::uint64_t, bool, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_) const noexcept
+    {
+	return ::crypto_secretbox_open_easy(mP_, cP_, cN_, n_.begin(), _secretKey.begin()) == 0;
+    }
+
+private:
+    const SecretKeyBaseType&				_secretKey;
+};
+
+template <Operation O, std::size_t S> class AuthEncAdDataSealStep {
+    static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal ChunkedAuthEncAdDataSealer type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ AuthEncAdDataSealer<Oper, S>::Overhead };
+
+    typedef AuthEncAdDataSealer<Oper, NonceSequentialSize>		SealerType;
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    constexpr static std::size_t			HeaderSize		{ authEncAdDataHeaderSize<NonceType>() };
+    constexpr static std::size_t			DataSize		{ dataSize<NonceType>() };
+
+    explicit AuthEncAdDataSealStep(const SecretKeyBaseType& sk_) noexcept
+	: _secretKey	{ sk_ }
+    {}
+
+    void start(unsigned char* p_, std::size_t chunkSize_, NonceType& n_)
+    {
+	unsigned char* const salt { writeHeader(_head, AuthEncAdDataMagic, NonceSequentialSize, chunkSize_) };
+	::randombytes_buf(salt, SaltSize);
+	subkey(_subkey, _secretKey, salt);
+	std::unique_ptr<SealerType> sealer { new SealerType(_subkey, _unused) };
+	_sealer.swap(sealer);
+	n_= NonceType(Tag::GenerateConstant);
+	n_(false);
+	std::copy(n_.constantBegin(), n_.constantEnd(), salt + SaltSize);
+	std::copy_n(_head, HeaderSize, p_);
+    }
+    void seal(const NonceType& n_, std::uint64_t index_, bool last_, const unsigned char* mP_, std::size_t mN_, unsigned char* cP_) const
+    {
+	unsigned char data[DataSize];
+	Chunked::data(data, _head, HeaderSize, index_, last_);
+	(*_sealer)(n_, mP_, mN_, data, DataSize, cP_);
+    }
+
+private:
+    const SecretKeyBaseType&				_secretKey;
+    SecretKeyType					_subkey;
+    NonceType						_unused;
+    std::unique_ptr<SealerType>				_sealer;
+    unsigned char					_head[HeaderSize];
+};
+
+template <Operation O, std::size_t S> class AuthEncAdDataOpenStep {
+    static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal ChunkedAuthEncAdDataOpener type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ AuthEncAdDataOpener<Oper, S>::Overhead };
+
+    typedef AuthEncAdDataOpener<Oper, NonceSequentialSize>		OpenerType;
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    constexpr static std::size_t			HeaderSize		{ authEncAdDataHeaderSize<NonceType>() };
+    constexpr static std::size_t			DataSize		{ dataSize<NonceType>() };
+
+    explicit AuthEncAdDataOpenStep(const SecretKeyBaseType& sk_) noexcept
+	: _secretKey	{ sk_ }
+    {}
+
+    std::size_t start(const unsigned char* p_, std::size_t n_, std::size_t maximumChunkSize_, NonceType& nonce_)
+    {
+	std::size_t chunkSize;
+	const unsigned char* const salt { readHeader(p_, n_, HeaderSize, AuthEncAdDataMagic, NonceSequentialSize, maximumChunkSize_, chunkSize) };
+	subkey(_subkey, _secretKey, salt);
+	std::unique_ptr<OpenerType> opener { new OpenerType(_subkey, _unused) };
+	_opener.swap(opener);
+	std::copy_n(p_, HeaderSize, _head);
+	nonce_= NonceType(salt + SaltSize, salt + SaltSize + NonceType::ConstantSize, Tag::SpecifyConstant);
+	return chunkSize;
+    }
+    bool open(const NonceType& n_, std::uint64_t index_, bool last_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_) const noexcept
+    {
+	unsigned char data[DataSize];
+	Chunked::data(data, _head, HeaderSize, index_, last_);
+	return (*_opener)(n_, cP_, cN_, data, DataSize, mP_, std::nothrow);
+    }
+
+private:
+    const SecretKeyBaseType&				_secretKey;
+    SecretKeyType					_subkey;
+    NonceType						_unused;
+    std::unique_ptr<OpenerType>				_opener;
+    unsigned char					_head[HeaderSize];
+};
+
+/*
+ * Sealer. The framing of every chunked format around its seal Step T: seals blobs in memory or from
+ * an istream to an ostream, the latter a window of chunks at a time. Chunks are sealed in parallel
+ * when a ThreadPool is given.
+ */
+template <typename T> class Sealer {
+public:
+    typedef T							StepType;
+
+    constexpr static Operation 				Oper			{ StepType::Oper };
+    constexpr static std::size_t			NonceSequentialSize	{ StepType::NonceSequentialSize };
+    constexpr static std::size_t			Overhead		{ StepType::Overhead };
+
+    typedef typename StepType::NonceType			NonceType;
+    typedef typename StepType::SecretKeyType			SecretKeyType;
+    typedef typename StepType::SecretKeyBaseType		SecretKeyBaseType;
+
+    constexpr static std::size_t			HeaderSize		{ StepType::HeaderSize };
+
+    const SecretKeyBaseType&				secretKey;
+    const std::size_t					chunkSize;
+
+    Sealer(const SecretKeyBaseType& sk_, std::size_t chunkSize_, ThreadPool* pool_, std::size_t window_)
+	: secretKey	{ sk_ }
+	, chunkSize	{ chunkSize_ }
+	, _pool		{ pool_ }
+	, _window	{ window_ > 0 ? window_ : pool_ ? 4 * pool_->threads() : 1 }
+	, _step		{ sk_ }
+    {
+	if(chunkSize == 0 || chunkSize > MaximumChunkSize)
+	    throw Exception(Exception::SizeMsg);
+    }
+    Sealer(const Sealer&) = delete;
+    Sealer(Sealer&&) = delete;
+
+    Sealer& operator = (const Sealer&) = delete;
+    Sealer& operator = (Sealer&&) = delete;
+
+    std::size_t size(std::size_t mN_) const noexcept
+    {
+	return HeaderSize + mN_ + (mN_ > 0 ? (mN_ + chunkSize - 1) / chunkSize : 1) * Overhead;
+    }
+
+    std::string operator () (const std::string& message_)
+    {
+	std::string result(size(message_.length()), '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < size(mN_))
+	    throw Exception(Exception::SizeMsg);
+	_step.start(cP_, chunkSize, _nonce);
+	_seal(0, mP_, mN_, cP_ + HeaderSize, true);
+	return size(mN_);
+    }
+    void operator () (std::istream& in_, std::ostream& out_)
+    {
+	if(!_buffer)
+	    _buffer.reset(new(Memory::Allocate) unsigned char[_window * (2 * chunkSize + Overhead)]);
+	unsigned char* const clear { _buffer.get() };
+	unsigned char* const cypher { clear + _window * chunkSize };
+	_step.start(cypher, chunkSize, _nonce);
+	out_.write(reinterpret_cast<const char*>(cypher), HeaderSize);
+	bool last { false };
+	for(std::uint64_t first { 0 }; !last; first+= _window)
+	{
+	    in_.read(reinterpret_cast<char*>(clear), static_cast<std::streamsize>(_window * chunkSize));
+	    const std::size_t n { static_cast<std::size_t>(in_.gcount()) };
+	    last= n < _window * chunkSize || in_.peek() == std::istream::traits_type::eof();
+	    out_.write(reinterpret_cast<const char*>(cypher), static_cast<std::streamsize>(_seal(first, clear, n, cypher, last)));
+	}
+	::sodium_memzero(clear, _window * chunkSize);
+	out_.flush();
+    }
+
+    /*
+     * Incremental sealing: header starts a blob with fresh random header fields and writes its
+     * HeaderSize byte header, chunks seals the mN_ bytes at mP_ as chunks first_ and on, last_ marks
+     * the run holding the final chunk. Returns the number of cypher bytes.
+     */
+    std::size_t header(unsigned char* p_)
+    {
+	_step.start(p_, chunkSize, _nonce);
+	return HeaderSize;
+    }
+    std::size_t chunks(std::uint64_t first_, const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, bool last_)
+    {
+	return _seal(first_, mP_, mN_, cP_, last_);
+    }
+
+private:
+    ThreadPool*						_pool;
+    const std::size_t					_window;
+    StepType						_step;
+    NonceType						_nonce;
+    std::unique_ptr<unsigned char[], Memory::Free>	_buffer;
+
+    std::size_t _seal(std::uint64_t first_, const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, bool last_)
+    {
+	const std::size_t chunks { mN_ > 0 ? (mN_ + chunkSize - 1) / chunkSize : 1 };
+	const NonceType base { _nonce + first_ };
+	const auto seal { [&](std::size_t b_, std::size_t e_) {
+	    for(std::size_t i { b_ }; i != e_; ++i)
+	    {
+		const bool last { last_ && i + 1 == chunks };
+		NonceType nonce { base + i };
+		nonce(last);
+		_step.seal(nonce, first_ + i, last, mP_ + i * chunkSize, std::min(chunkSize, mN_ - i * chunkSize), cP_ + i * (chunkSize + Overhead));
+	    }
+	} };
+	if(_pool)
+	    (*_pool)(chunks, 1, seal);
+	else
+	    seal(0, chunks);
+	return mN_ + chunks * Overhead;
+    }
+};
+
+/*
+ * Opener. The framing of every chunked format around its open Step T, refusing chunk sizes over
+ * maximumChunkSize so the memory an istream to ostream open takes stays bounded. When a chunk fails
+ * to verify all clear bytes of the call are wiped, but streamed plaintext of earlier windows has
+ * already been written.
+ */
+template <typename T> class Opener {
+public:
+    typedef T							StepType;
+
+    constexpr static Operation 				Oper			{ StepType::Oper };
+    constexpr static std::size_t			NonceSequentialSize	{ StepType::NonceSequentialSize };
+    constexpr static std::size_t			Overhead		{ StepType::Overhead };
+
+    typedef typename StepType::NonceType			NonceType;
+    typedef typename StepType::SecretKeyType			SecretKeyType;
+    typedef typename StepType::SecretKeyBaseType		SecretKeyBaseType;
+
+    constexpr static std::size_t			HeaderSize		{ StepType::HeaderSize };
+
+    const SecretKeyBaseType&				secretKey;
+    const std::size_t					maximumChunkSize;
+
+    Opener(const SecretKeyBaseType& sk_, ThreadPool* pool_, std::size_t window_, std::size_t maximumChunkSize_)
+	: secretKey		{ sk_ }
+	, maximumChunkSize	{ maximumChunkSize_ }
+	, _pool			{ pool_ }
+	, _window		{ window_ > 0 ? window_ : pool_ ? 4 * pool_->threads() : 1 }
+	, _step			{ sk_ }
+	, _chunkSize		{ 0 }
+	, _bufferSize		{ 0 }
+    {}
+    Opener(const Opener&) = delete;
+    Opener(Opener&&) = delete;
+
+    Opener& operator = (const Opener&) = delete;
+    Opener& operator = (Opener&&) = delete;
+
+    std::string operator () (const std::string& cypher_)
+    {
+	const unsigned char* cP { reinterpret_cast<const unsigned char*>(&cypher_[0]) };
+	_header(cP, cypher_.length());
+	std::string result(_size(cypher_.length() - HeaderSize), '\0');
+	_open(0, cP + HeaderSize, cypher_.length() - HeaderSize, reinterpret_cast<unsigned char*>(&result[0]), true);
+	return result;
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	_header(cP_, cN_);
+	if(mN_ < _size(cN_ - HeaderSize))
+	    throw Exception(Exception::SizeMsg);
+	return _open(0, cP_ + HeaderSize, cN_ - HeaderSize, mP_, true);
+    }
+    void operator () (std::istream& in_, std::ostream& out_)
+    {
+	unsigned char header[HeaderSize];
+	in_.read(reinterpret_cast<char*>(header), HeaderSize);
+	_header(header, static_cast<std::size_t>(in_.gcount()));
+	const std::size_t sealedChunkSize { _chunkSize + Overhead };
+	if(_bufferSize < _window * (2 * _chunkSize + Overhead))
+	{
+	    const std::size_t bufferSize { _window * (2 * _chunkSize + Overhead) };
+	    std::unique_ptr<unsigned char[], Memory::Free> buffer { new(Memory::Allocate) unsigned char[bufferSize] };
+	    _buffer.swap(buffer);
+	    _bufferSize= bufferSize;
+	}
+	unsigned char* const cypher { _buffer.get() };
+	unsigned char* const clear { cypher + _window * sealedChunkSize };
+	bool last { false };
+	for(std::uint64_t first { 0 }; !last; first+= _window)
+	{
+	    in_.read(reinterpret_cast<char*>(cypher), static_cast<std::streamsize>(_window * sealedChunkSize));
+	    const std::size_t n { static_cast<std::size_t>(in_.gcount()) };
+	    last= n < _window * sealedChunkSize || in_.peek() == std::istream::traits_type::eof();
+	    const std::size_t m { _open(first, cypher, n, clear, last) };
+	    out_.write(reinterpret_cast<const char*>(clear), static_cast<std::streamsize>(m));
+	    ::sodium_memzero(clear, m);
+	}
+	out_.flush();
+    }
+
+    /*
+     * Incremental opening: header reads a HeaderSize byte header and returns the blob's chunk size,
+     * chunks opens the cypher bytes of chunks first_ and on, last_ marks the run holding the final
+     * chunk. Returns the number of clear bytes.
+     */
+    std::size_t header(const unsigned char* p_, std::size_t n_)
+    {
+	_header(p_, n_);
+	return _chunkSize;
+    }
+    std::size_t chunks(std::uint64_t first_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, bool last_)
+    {
+	return _open(first_, cP_, cN_, mP_, last_);
+    }
+
+private:
+    ThreadPool*						_pool;
+    const std::size_t					_window;
+    StepType						_step;
+    NonceType						_nonce;
+    std::size_t						_chunkSize;
+    std::size_t						_bufferSize;
+    std::unique_ptr<unsigned char[], Memory::Free>	_buffer;
+
+    void _header(const unsigned char* p_, std::size_t n_)
+    {
+	_chunkSize= _step.start(p_, n_, maximumChunkSize, _nonce);
+    }
+    std::size_t _size(std::size_t cN_) const noexcept
+    {
+	const std::size_t chunks { (cN_ + _chunkSize + Overhead - 1) / (_chunkSize + Overhead) };
+	return cN_ > chunks * Overhead ? cN_ - chunks * Overhead : 0;
+    }
+    std::size_t _open(std::uint64_t first_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, bool last_)
+    {
+	const std::size_t sealedChunkSize { _chunkSize + Overhead };
+	const std::size_t chunks { (cN_ + sealedChunkSize - 1) / sealedChunkSize };
+	if(chunks == 0 || cN_ - (chunks - 1) * sealedChunkSize < Overhead)
+	    throw VerificationError();
+	const NonceType base { _nonce + first_ };
+	std::atomic<bool> failed { false };
+	const auto open { [&](std::size_t b_, std::size_t e_) {
+	    for(std::size_t i { b_ }; i != e_; ++i)
+	    {
+		const bool last { last_ && i + 1 == chunks };
+		NonceType nonce { base + i };
+		nonce(last);
+		if(!_step.open(nonce, first_ + i, last, cP_ + i * sealedChunkSize, std::min(sealedChunkSize, cN_ - i * sealedChunkSize),
+			       mP_ + i * _chunkSize))
+		    failed= true;
+	    }
+	} };
+	if(_pool)
+	    (*_pool)(chunks, 1, open);
+	else
+	    open(0, chunks);
+	if(failed)
+	{
+	    ::sodium_memzero(mP_, cN_ - chunks * Overhead);
+	    throw VerificationError();
+	}
+	return cN_ - chunks * Overhead;
+    }
+};
+
+} // namespace Chunked
+
+/*
+ * ChunkedSealer. Seals blobs in the Chunked SecretBox format.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize>
+class ChunkedSealer: public Chunked::Sealer<Chunked::SecretBoxSealStep<O, S>> {
+public:
+    ChunkedSealer(const SecretKeyBase<OperationTraits<O>::SecretKeySize>& sk_, std::size_t chunkSize_ = Chunked::DefaultChunkSize,
+			   ThreadPool* pool_ = nullptr, std::size_t window_ = 0)
+	: Chunked::Sealer<Chunked::SecretBoxSealStep<O, S>>(sk_, chunkSize_, pool_, window_)
+    {}
+};
+
+/*
+ * ChunkedOpener. Opens ChunkedSealer blobs.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize>
+class ChunkedOpener: public Chunked::Opener<Chunked::SecretBoxOpenStep<O, S>> {
+public:
+    explicit ChunkedOpener(const SecretKeyBase<OperationTraits<O>::SecretKeySize>& sk_, ThreadPool* pool_ = nullptr, std::size_t window_ = 0,
+			   std::size_t maximumChunkSize_ = Chunked::MaximumChunkSize)
+	: Chunked::Opener<Chunked::SecretBoxOpenStep<O, S>>(sk_, pool_, window_, maximumChunkSize_)
+    {}
+};
+
+/*
+ * ChunkedAuthEncAdDataSealer. Streaming AuthEncAdData: the ChunkedSealer interface and framing with
+ * an AuthEncAdDataSealer per chunk, the chunk index and final flag in both the Nonce and the
+ * associated data, so truncated, extended and reordered streams don't verify.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize>
+class ChunkedAuthEncAdDataSealer: public Chunked::Sealer<Chunked::AuthEncAdDataSealStep<O, S>> {
+public:
+    ChunkedAuthEncAdDataSealer(const SecretKeyBase<OperationTraits<O>::SecretKeySize>& sk_,
+					std::size_t chunkSize_ = Chunked::DefaultChunkSize, ThreadPool* pool_ = nullptr, std::size_t window_ = 0)
+	: Chunked::Sealer<Chunked::AuthEncAdDataSealStep<O, S>>(sk_, chunkSize_, pool_, window_)
+    {}
+};
+
+/*
+ * ChunkedAuthEncAdDataOpener. Opens ChunkedAuthEncAdDataSealer streams, as ChunkedOpener.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize>
+class ChunkedAuthEncAdDataOpener: public Chunked::Opener<Chunked::AuthEncAdDataOpenStep<O, S>> {
+public:
+    explicit ChunkedAuthEncAdDataOpener(const SecretKeyBase<OperationTraits<O>::SecretKeySize>& sk_, ThreadPool* pool_ = nullptr,
+					std::size_t window_ = 0, std::size_t maximumChunkSize_ = Chunked::MaximumChunkSize)
+	: Chunked::Opener<Chunked::AuthEncAdDataOpenStep<O, S>>(sk_, pool_, window_, maximumChunkSize_)
+    {}
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOCHUNKED_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
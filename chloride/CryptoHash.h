@@ -31,6 +31,9 @@
 #include <sodium/crypto_generichash_blake2b.h>
 #include <sodium/crypto_pwhash_scryptsalsa208sha256.h>
 
+#include <vector>
+
+#include "CryptoMemory.h"
 #include "CryptoSalt.h"
 #include "CryptoSecretKey.h"
 
@@ -213,6 +216,16 @@ public:
 	{
 	    return operator()(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length());
 	}
+	Builder& operator () (const Segment* begin_, const Segment* end_) noexcept
+	{
+	    for(auto i { begin_ }; i != end_; ++i)
+		operator()(i->pointer, i->length);
+	    return *this;
+	}
+	Builder& operator () (const std::vector<Segment>& segments_) noexcept
+	{
+	    return operator()(segments_.data(), segments_.data() + segments_.size());
+	}
     };
 
     Hash() noexcept = default;
@@ -233,6 +246,12 @@ public:
     Hash(const std::string& s_) noexcept
 	: Hash<Oper>(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length())
     {}
+    Hash(const Segment* begin_, const Segment* end_) noexcept
+	: Hash<Oper>(Builder()(begin_, end_))
+    {}
+    Hash(const std::vector<Segment>& segments_) noexcept
+	: Hash<Oper>(Builder()(segments_))
+    {}
 };
 
 template<> class Hash<Operation::HashSha512>: public HashBase<OperationTraits<Operation::HashSha512>::HashSize> {
@@ -261,6 +280,16 @@ public:
 	{
 	    return operator()(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length());
 	}
+	Builder& operator () (const Segment* begin_, const Segment* end_) noexcept
+	{
+	    for(auto i { begin_ }; i != end_; ++i)
+		operator()(i->pointer, i->length);
+	    return *this;
+	}
+	Builder& operator () (const std::vector<Segment>& segments_) noexcept
+	{
+	    return operator()(segments_.data(), segments_.data() + segments_.size());
+	}
     };
 
     Hash() noexcept = default;
@@ -281,6 +310,12 @@ public:
     Hash(const std::string& s_) noexcept
 	: Hash<Oper>(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length())
     {}
+    Hash(const Segment* begin_, const Segment* end_) noexcept
+	: Hash<Oper>(Builder()(begin_, end_))
+    {}
+    Hash(const std::vector<Segment>& segments_) noexcept
+	: Hash<Oper>(Builder()(segments_))
+    {}
 };
 
 template<> class Hash<Operation::ShortHashSipHash24>: public HashBase<OperationTraits<Operation::ShortHashSipHash24>::HashSize> {
@@ -305,6 +340,16 @@ public:
     Hash(const SecretKeyBaseType& sk_, const std::string& s_) noexcept
 	: Hash<Oper>(sk_, reinterpret_cast<const unsigned char*>(&s_[0]), s_.length())
     {}
+    Hash(const SecretKeyBaseType& sk_, const Segment* begin_, const Segment* end_)
+    {
+	static thread_local Memory::Scratch scratch;
+	const Memory::Scratch::Wipe wipe { scratch };
+	scratch(begin_, end_);
+	::crypto_shorthash_siphash24(HashBase<Size>::begin(), scratch.begin(), scratch.size(), sk_.begin());
+    }
+    Hash(const SecretKeyBaseType& sk_, const std::vector<Segment>& segments_)
+	: Hash<Oper>(sk_, segments_.data(), segments_.data() + segments_.size())
+    {}
 };
 
 /*
@@ -363,6 +408,16 @@ public:
 	{
 	    return operator()(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length());
 	}
+	Builder& operator () (const Segment* begin_, const Segment* end_) noexcept
+	{
+	    for(auto i { begin_ }; i != end_; ++i)
+		operator()(i->pointer, i->length);
+	    return *this;
+	}
+	Builder& operator () (const std::vector<Segment>& segments_) noexcept
+	{
+	    return operator()(segments_.data(), segments_.data() + segments_.size());
+	}
     };
 
     SizedHash() noexcept = default;
@@ -389,6 +444,16 @@ public:
     SizedHash(const SecretKeyBase<KS>& k_, const std::string& s_) noexcept
 	: SizedHash<Oper, Size>(k_, reinterpret_cast<const unsigned char*>(&s_[0]), s_.length())
     {}
+    template <std::size_t KS, typename std::enable_if<   MinimumSecretKeySize <= KS
+						      && KS <= MaximumSecretKeySize>::type* = nullptr>
+    SizedHash(const SecretKeyBase<KS>& k_, const Segment* begin_, const Segment* end_) noexcept
+	: SizedHash<Oper, Size>(Builder(k_)(begin_, end_))
+    {}
+    template <std::size_t KS, typename std::enable_if<   MinimumSecretKeySize <= KS
+						      && KS <= MaximumSecretKeySize>::type* = nullptr>
+    SizedHash(const SecretKeyBase<KS>& k_, const std::vector<Segment>& segments_) noexcept
+	: SizedHash<Oper, Size>(Builder(k_)(segments_))
+    {}
     template <std::size_t KS, typename std::enable_if<   MinimumSecretKeySize <= KS
 						      && KS <= MaximumSecretKeySize>::type* = nullptr>
     SizedHash(const SecretKeyBase<KS>& k_, const SaltType& st_, const SeedType& personal_,
@@ -409,6 +474,18 @@ public:
 	      const std::string& s_) noexcept
 	: SizedHash<Oper, Size>(k_, st_, personal_, reinterpret_cast<const unsigned char*>(&s_[0]), s_.length())
     {}
+    template <std::size_t KS, typename std::enable_if<   MinimumSecretKeySize <= KS
+						      && KS <= MaximumSecretKeySize>::type* = nullptr>
+    SizedHash(const SecretKeyBase<KS>& k_, const SaltType& st_, const SeedType& personal_,
+	      const Segment* begin_, const Segment* end_) noexcept
+	: SizedHash<Oper, Size>(Builder(k_, st_, personal_)(begin_, end_))
+    {}
+    template <std::size_t KS, typename std::enable_if<   MinimumSecretKeySize <= KS
+						      && KS <= MaximumSecretKeySize>::type* = nullptr>
+    SizedHash(const SecretKeyBase<KS>& k_, const SaltType& st_, const SeedType& personal_,
+	      const std::vector<Segment>& segments_) noexcept
+	: SizedHash<Oper, Size>(Builder(k_, st_, personal_)(segments_))
+    {}
 };
 
 /*
@@ -25,8 +25,11 @@
 #ifndef CHLORIDE_CRYPTOMEMORY_H_
 #define CHLORIDE_CRYPTOMEMORY_H_
 
+#include <algorithm>
+#include <mutex>
 #include <new>
 #include <memory>
+#include <vector>
 
 #include "CryptoBase.h"
 
@@ -109,6 +112,107 @@ template <Access A> inline void access(void* pointer_)
 template <Access A, typename T> inline void access(std::shared_ptr<T>& sp_)			{ access<A>(sp_.get()); }
 template <Access A, typename T, typename D> inline void access(std::unique_ptr<T, D>& up_)	{ access<A>(up_.get()); }
 
+/*
+ * Xor q_ into p_, with the widest kernel (AVX2, SSE2 or 64 bit words) the CPU supports at runtime.
+ */
+void xorBytes(unsigned char* p_, const unsigned char* q_, std::size_t n_) noexcept;
+const char* xorKernel() noexcept;
+
+/*
+ * Scratch. Locked buffer for linearizing Segments, it grows to the largest content it was given and
+ * its content is wiped by clear(), by the Wipe guard and on destruction.
+ */
+class Scratch {
+public:
+    struct Wipe {
+	Scratch&					scratch;
+
+	~Wipe() noexcept					{ scratch.clear(); }
+    };
+
+    Scratch() noexcept
+	: _capacity	{ 0 }
+	, _size		{ 0 }
+    {}
+    Scratch(const Scratch&) = delete;
+    Scratch(Scratch&&) = delete;
+    ~Scratch() noexcept						{ clear(); }
+
+    Scratch& operator = (const Scratch&) = delete;
+    Scratch& operator = (Scratch&&) = delete;
+
+    /*
+     * Appends the Segments and returns their total length, earlier pointers are invalidated.
+     */
+    std::size_t operator () (const Segment* begin_, const Segment* end_)
+    {
+	std::size_t n { 0 };
+	for(auto i { begin_ }; i != end_; ++i)
+	    n+= i->length;
+	if(!_bytes || _size + n > _capacity)
+	{
+	    const std::size_t capacity { std::max(((std::max(_size + n, 2 * _capacity) + Alignment - 1) >> AlignmentShift) << AlignmentShift,
+						  Alignment) };
+	    std::unique_ptr<unsigned char[], Free> bytes { new(Allocate) unsigned char[capacity] };
+	    std::copy_n(_bytes.get(), _size, bytes.get());
+	    _bytes.swap(bytes);
+	    _capacity= capacity;
+	}
+	for(auto i { begin_ }; i != end_; ++i)
+	{
+	    std::copy_n(i->pointer, i->length, _bytes.get() + _size);
+	    _size+= i->length;
+	}
+	return n;
+    }
+
+    const unsigned char* begin() const noexcept			{ return _bytes.get(); }
+    const unsigned char* end() const noexcept			{ return _bytes.get() + _size; }
+    std::size_t size() const noexcept				{ return _size; }
+
+    void clear() noexcept
+    {
+	if(_size > 0)
+	    ::sodium_memzero(_bytes.get(), _size);
+	_size= 0;
+    }
+
+private:
+    std::unique_ptr<unsigned char[], Free>		_bytes;
+    std::size_t						_capacity;
+    std::size_t						_size;
+};
+
+/*
+ * Pool. Hands out fixed size, Alignment aligned slots carved from locked blocks of slotsPerBlock
+ * slots, so many small locked buffers don't each cost a sodium_malloc with its guard pages.
+ * Slots are wiped when they are returned and reused before a new block is allocated, blocks are
+ * only freed with the Pool. Allocation and release are thread safe.
+ */
+class Pool {
+public:
+    explicit Pool(std::size_t slotSize_, std::size_t slotsPerBlock_ = 64);
+    Pool(const Pool&) = delete;
+    Pool(Pool&&) = delete;
+
+    Pool& operator = (const Pool&) = delete;
+    Pool& operator = (Pool&&) = delete;
+
+    unsigned char* allocate();
+    void release(unsigned char* slot_) noexcept;
+
+    std::size_t slotSize() const noexcept			{ return _slotSize; }
+    std::size_t capacity();
+    std::size_t available();
+
+private:
+    const std::size_t					_slotSize;
+    const std::size_t					_slotsPerBlock;
+    std::vector<std::unique_ptr<unsigned char[], Free>>	_blocks;
+    std::vector<unsigned char*>				_free;
+    std::mutex						_mutex;
+};
+
 } // namespace Memory
 } //namespace Crypto
 
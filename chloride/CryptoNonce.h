@@ -28,6 +28,7 @@
 #include <sodium/randombytes.h>
 
 #include <algorithm>
+#include <cstdint>
 
 #include "CryptoBase.h"
 
@@ -87,6 +88,24 @@ public:
 	    throw Exception(Exception::OverflowMsg);
 	return *this;
     }
+    Nonce& operator += (std::uint64_t n_)
+    {
+	unsigned int carry { 0 };
+	for(std::size_t i { 0 }; i != SequentialSize; ++i, n_>>= 8)
+	{
+	    carry+= static_cast<unsigned int>(sequentialBegin()[i]) + static_cast<unsigned int>(n_ & 0xFF);
+	    sequentialBegin()[i]= static_cast<unsigned char>(carry);
+	    carry>>= 8;
+	}
+	if(carry != 0 || n_ != 0)
+	    throw Exception(Exception::OverflowMsg);
+	return *this;
+    }
+    Nonce operator + (std::uint64_t n_) const
+    {
+	Nonce result { *this };
+	return result+= n_;
+    }
 
     Nonce& operator () (bool flag_) noexcept
     {
@@ -0,0 +1,307 @@
+/*
+** CryptoRecord.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHLORIDE_CRYPTORECORD_H_
+#define CHLORIDE_CRYPTORECORD_H_
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "CryptoAuthEncAdData.h"
+
+namespace Crypto {
+/*
+ * Record format. A little endian 32 bit message length header followed by the AuthEncAdData cypher of
+ * the message with the header as associated data, one Nonce increment per record. Failing reads and
+ * writes throw std::system_error with the errno of the call.
+ */
+namespace Record {
+constexpr std::size_t		HeaderSize		{ 4 };
+constexpr std::size_t		DefaultMaximumRecordSize{ 0x4000 };
+constexpr std::size_t		MaximumRecordSize	{ 0x1000000 };
+constexpr std::size_t		DefaultQueueSize	{ 0x10000 };
+// Well below the IOV_MAX of any POSIX system that matters, at least the 16 POSIX guarantees.
+constexpr std::size_t		MaximumIovecs		{ 64 };
+
+// Returns n_ when it is a valid maximum record size, throws before anything gets sized by it otherwise.
+inline std::size_t checkMaximumRecordSize(std::size_t n_)
+{
+    if(n_ == 0 || n_ > MaximumRecordSize)
+	throw Exception(Exception::SizeMsg);
+    return n_;
+}
+
+inline void header(unsigned char* p_, std::size_t n_) noexcept
+{
+    for(std::size_t i { 0 }; i != HeaderSize; ++i)
+	p_[i]= static_cast<unsigned char>(n_ >> (8 * i));
+}
+inline std::size_t header(const unsigned char* p_) noexcept
+{
+    std::size_t result { 0 };
+    for(std::size_t i { HeaderSize }; i != 0; --i)
+	result= result << 8 | p_[i - 1];
+    return result;
+}
+
+// Write all of iov_[0, n_) to fd_, retrying partial writes and EINTR, iov_ is consumed.
+void write(int fd_, ::iovec* iov_, std::size_t n_);
+// Read at most n_ bytes from fd_ into p_, retrying EINTR, 0 at end of file.
+std::size_t read(int fd_, unsigned char* p_, std::size_t n_);
+} // namespace Record
+
+/*
+ * RecordSealer. Seals records straight into a queue and writes queued records to a blocking stream
+ * file descriptor with a single writev per flush(), which happens on demand, when the queue is full
+ * or on destruction. The Tailroom variant seals a caller buffer with Overhead bytes of room behind
+ * the message in place and queues it without copying, the buffer must stay put until the next flush.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize> class RecordSealer {
+    static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal RecordSealer type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			PadSize			{ AuthEncAdDataSealer<Oper, S>::Overhead };
+    constexpr static std::size_t			Overhead		{ Record::HeaderSize + PadSize };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    NonceType&						nonce;
+    const int						fd;
+    const std::size_t					maximumRecordSize;
+
+    RecordSealer(const SecretKeyBaseType& sk_, NonceType& n_, int fd_, std::size_t maximumRecordSize_ = Record::DefaultMaximumRecordSize,
+		 std::size_t queueSize_ = Record::DefaultQueueSize)
+	: nonce			{ n_ }
+	, fd			{ fd_ }
+	, maximumRecordSize	{ Record::checkMaximumRecordSize(maximumRecordSize_) }
+	, _sealer		{ sk_, n_ }
+	, _queueSize		{ std::max(queueSize_, maximumRecordSize + Overhead) }
+	, _queue		{ new(Memory::Allocate) unsigned char[_queueSize] }
+	, _used			{ 0 }
+	, _pending		{ 0 }
+    {
+	_iov.reserve(Record::MaximumIovecs);
+    }
+    RecordSealer(const RecordSealer&) = delete;
+    RecordSealer(RecordSealer&&) = delete;
+    ~RecordSealer() noexcept
+    {
+	try {
+	    flush();
+	}
+	catch(...)
+	{}
+    }
+
+    RecordSealer& operator = (const RecordSealer&) = delete;
+    RecordSealer& operator = (RecordSealer&&) = delete;
+
+    void operator () (const std::string& message_)
+    {
+	operator()(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length());
+    }
+    void operator () (const unsigned char* mP_, std::size_t mN_)
+    {
+	if(mN_ > maximumRecordSize)
+	    throw Exception(Exception::SizeMsg);
+	_reserve(mN_ + Overhead, 1);
+	unsigned char* const p { _queue.get() + _used };
+	Record::header(p, mN_);
+	_sealer(mP_, mN_, p, Record::HeaderSize, p + Record::HeaderSize, mN_ + PadSize);
+	_used+= mN_ + Overhead;
+	_append(p, mN_ + Overhead);
+    }
+    void operator () (unsigned char* p_, std::size_t n_, Tag::TailroomTag)
+    {
+	if(n_ > maximumRecordSize)
+	    throw Exception(Exception::SizeMsg);
+	_reserve(Record::HeaderSize, 2);
+	unsigned char* const h { _queue.get() + _used };
+	Record::header(h, n_);
+	_sealer(p_, n_, h, Record::HeaderSize, Tag::Tailroom);
+	_used+= Record::HeaderSize;
+	_append(h, Record::HeaderSize);
+	_append(p_, n_ + PadSize);
+    }
+
+    void flush()
+    {
+	if(_iov.empty())
+	    return;
+	// Whatever happens the queue starts over, a failed write leaves the stream unusable anyway.
+	try {
+	    Record::write(fd, _iov.data(), _iov.size());
+	}
+	catch(...)
+	{
+	    _clear();
+	    throw;
+	}
+	_clear();
+    }
+
+    // Queued bytes not written yet.
+    std::size_t pending() const noexcept			{ return _pending; }
+
+private:
+    AuthEncAdDataSealer<Oper, NonceSequentialSize>	_sealer;
+    const std::size_t					_queueSize;
+    std::unique_ptr<unsigned char[], Memory::Free>	_queue;
+    std::size_t						_used;
+    std::size_t						_pending;
+    std::vector<::iovec>				_iov;
+
+    void _reserve(std::size_t n_, std::size_t iovecs_)
+    {
+	if(_used + n_ > _queueSize || _iov.size() + iovecs_ > Record::MaximumIovecs)
+	    flush();
+    }
+    void _clear() noexcept
+    {
+	_iov.clear();
+	_used= 0;
+	_pending= 0;
+    }
+    // Records sealed back to back into the queue share one iovec.
+    void _append(unsigned char* p_, std::size_t n_)
+    {
+	if(!_iov.empty() && static_cast<unsigned char*>(_iov.back().iov_base) + _iov.back().iov_len == p_)
+	    _iov.back().iov_len+= n_;
+	else
+	    _iov.push_back(::iovec { p_, n_ });
+	_pending+= n_;
+    }
+};
+
+/*
+ * RecordOpener. Reads records from a blocking stream file descriptor into a receive buffer, as many
+ * as one read brings in, and decrypts them in place. A record is only moved to the front of the buffer
+ * when it would run past the end, so the message handed out stays valid until the next call.
+ * Returns false on end of file between records, a truncated or oversized record throws FormatMsg
+ * and a record that doesn't verify VerificationError.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize> class RecordOpener {
+    static_assert(OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal RecordOpener type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			PadSize			{ AuthEncAdDataOpener<Oper, S>::Overhead };
+    constexpr static std::size_t			Overhead		{ Record::HeaderSize + PadSize };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    NonceType&						nonce;
+    const int						fd;
+    const std::size_t					maximumRecordSize;
+
+    RecordOpener(const SecretKeyBaseType& sk_, NonceType& n_, int fd_, std::size_t maximumRecordSize_ = Record::DefaultMaximumRecordSize)
+	: nonce			{ n_ }
+	, fd			{ fd_ }
+	, maximumRecordSize	{ Record::checkMaximumRecordSize(maximumRecordSize_) }
+	, _opener		{ sk_, n_ }
+	, _capacity		{ 2 * (maximumRecordSize + Overhead) }
+	, _buffer		{ new(Memory::Allocate) unsigned char[_capacity] }
+	, _begin		{ 0 }
+	, _end			{ 0 }
+    {}
+    RecordOpener(const RecordOpener&) = delete;
+    RecordOpener(RecordOpener&&) = delete;
+
+    RecordOpener& operator = (const RecordOpener&) = delete;
+    RecordOpener& operator = (RecordOpener&&) = delete;
+
+    bool operator () (std::string& message_)
+    {
+	Segment message;
+	if(!operator()(message))
+	    return false;
+	message_.assign(reinterpret_cast<const char*>(message.pointer), message.length);
+	return true;
+    }
+    bool operator () (Segment& message_)
+    {
+	if(!_fill(Record::HeaderSize))
+	    return false;
+	const std::size_t n { Record::header(_buffer.get() + _begin) };
+	if(n > maximumRecordSize)
+	    throw Exception(Exception::FormatMsg);
+	if(!_fill(n + Overhead))
+	    throw Exception(Exception::FormatMsg);
+	unsigned char* const p { _buffer.get() + _begin };
+	_opener(p + Record::HeaderSize, n + PadSize, p, Record::HeaderSize, Tag::Tailroom);
+	_begin+= n + Overhead;
+	message_= Segment(p + Record::HeaderSize, n);
+	return true;
+    }
+
+    // Received bytes not handed out yet.
+    std::size_t buffered() const noexcept			{ return _end - _begin; }
+
+private:
+    AuthEncAdDataOpener<Oper, NonceSequentialSize>	_opener;
+    const std::size_t					_capacity;
+    std::unique_ptr<unsigned char[], Memory::Free>	_buffer;
+    std::size_t						_begin;
+    std::size_t						_end;
+
+    // Buffer at least n_ bytes from _begin on, false on end of file with nothing buffered.
+    bool _fill(std::size_t n_)
+    {
+	if(_begin == _end)
+	    _begin= _end= 0;
+	while(_end - _begin < n_)
+	{
+	    if(_capacity - _begin < n_)
+	    {
+		std::memmove(_buffer.get(), _buffer.get() + _begin, _end - _begin);
+		_end-= _begin;
+		_begin= 0;
+	    }
+	    const std::size_t n { Record::read(fd, _buffer.get() + _end, _capacity - _end) };
+	    if(n == 0)
+	    {
+		if(_begin == _end)
+		    return false;
+		throw Exception(Exception::FormatMsg);
+	    }
+	    _end+= n;
+	}
+	return true;
+    }
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTORECORD_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -0,0 +1,157 @@
+/*
+** CryptoReplay.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CHLORIDE_CRYPTOREPLAY_H_
+#define CHLORIDE_CRYPTOREPLAY_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <new>
+
+#include "CryptoNonce.h"
+
+namespace Crypto {
+/*
+ * ReplayWindow. Remembers which of the last Size sequence numbers up to the highest one seen have
+ * been accepted, anything older is refused.
+ */
+template <std::size_t W = 1024> class ReplayWindow {
+    static_assert(W > 0 && W % 64 == 0, "Illegal ReplayWindow size!");
+public:
+    constexpr static std::size_t			Size		{ W };
+
+    ReplayWindow() noexcept
+	: _highest	{ 0 }
+	, _empty	{ true }
+	, _bits		{}
+    {}
+
+    bool accepts(std::uint64_t n_) const noexcept
+    {
+	return _empty || n_ > _highest || (_highest - n_ < Size && !((_bits[_word(n_)] >> (n_ % 64)) & 1));
+    }
+    void accept(std::uint64_t n_) noexcept
+    {
+	if(_empty || n_ > _highest)
+	{
+	    if(_empty || n_ - _highest >= Size)
+		std::fill(std::begin(_bits), std::end(_bits), 0);
+	    else
+		for(std::uint64_t i { n_ }; i != _highest; --i)
+		    _bits[_word(i)]&= ~(std::uint64_t { 1 } << (i % 64));
+	    _highest= n_;
+	    _empty= false;
+	}
+	_bits[_word(n_)]|= std::uint64_t { 1 } << (n_ % 64);
+    }
+
+    std::uint64_t highest() const noexcept			{ return _highest; }
+    void clear() noexcept					{ *this= ReplayWindow(); }
+
+private:
+    std::uint64_t					_highest;
+    bool						_empty;
+    std::uint64_t					_bits[Size / 64];
+
+    static std::size_t _word(std::uint64_t n_) noexcept		{ return static_cast<std::size_t>((n_ / 64) % (Size / 64)); }
+};
+
+/*
+ * ReplayOpener. Opens with a BoxOpener or AuthEncAdDataOpener using the sequence number carried by
+ * the message as the Nonce sequential part, on top of the constant part of the opener's nonce as it
+ * was at construction. Messages may arrive in any order within the ReplayWindow, repeated, too old
+ * and unverifiable messages throw VerificationError and don't move the window.
+ */
+template <typename O, std::size_t W = 1024> class ReplayOpener {
+public:
+    constexpr static std::size_t			Overhead	{ O::Overhead };
+
+    typedef O						OpenerType;
+    typedef typename OpenerType::NonceType		NonceType;
+    typedef ReplayWindow<W>				ReplayWindowType;
+
+    OpenerType&						opener;
+    ReplayWindowType					window;
+
+    explicit ReplayOpener(OpenerType& o_)
+	: opener	{ o_ }
+	, _nonce	{ o_.nonce.constantBegin(), o_.nonce.constantEnd(), Tag::SpecifyConstant }
+    {}
+    ReplayOpener(const ReplayOpener&) = delete;
+    ReplayOpener(ReplayOpener&&) = delete;
+
+    ReplayOpener& operator = (const ReplayOpener&) = delete;
+    ReplayOpener& operator = (ReplayOpener&&) = delete;
+
+    std::string operator () (std::uint64_t sequence_, const std::string& cypher_)
+    {
+	if(cypher_.length() < Overhead)
+	    throw VerificationError();
+	std::string result(cypher_.length() - Overhead, '\0');
+	operator()(sequence_, reinterpret_cast<const unsigned char*>(&cypher_[0]), cypher_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (std::uint64_t sequence_, const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	_check(sequence_, cN_, mN_);
+	if(!opener(_nonce + sequence_, cP_, cN_, mP_, std::nothrow))
+	    throw VerificationError();
+	window.accept(sequence_);
+	return cN_ - Overhead;
+    }
+    std::size_t operator () (std::uint64_t sequence_, const unsigned char* cP_, std::size_t cN_, const unsigned char* dP_, std::size_t dN_,
+			     unsigned char* mP_, std::size_t mN_)
+    {
+	_check(sequence_, cN_, mN_);
+	if(!opener(_nonce + sequence_, cP_, cN_, dP_, dN_, mP_, std::nothrow))
+	    throw VerificationError();
+	window.accept(sequence_);
+	return cN_ - Overhead;
+    }
+
+private:
+    const NonceType					_nonce;
+
+    // Sequence numbers the Nonce sequential part can't hold are forgeries too, not Nonce overflows.
+    static bool _fits(std::uint64_t sequence_) noexcept
+    {
+	return NonceType::SequentialSize >= 8 || sequence_ >> (8 * (NonceType::SequentialSize % 8)) == 0;
+    }
+    void _check(std::uint64_t sequence_, std::size_t cN_, std::size_t mN_) const
+    {
+	if(cN_ < Overhead || !_fits(sequence_) || !window.accepts(sequence_))
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+    }
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOREPLAY_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
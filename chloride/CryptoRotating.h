@@ -0,0 +1,352 @@
+/*
+** CryptoRotating.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHLORIDE_CRYPTOROTATING_H_
+#define CHLORIDE_CRYPTOROTATING_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "CryptoAuthEncAdData.h"
+#include "CryptoBox.h"
+#include "CryptoHash.h"
+
+namespace Crypto {
+/*
+ * Rotating format. An epoch byte, the low byte of the epoch number, followed by the cypher of the
+ * SecretBox or AuthEncAdData Operation. Epoch e + 1 uses the key BLAKE2b(key e, Label, little endian
+ * 64 bit e + 1), so old keys can't be recomputed from newer ones, and restarts the Nonce sequential
+ * part at zero under its new key. A sealer moves to the next epoch when the message or byte budget of
+ * the current one is spent, by default well before the Nonce runs out or AES256-GCM's 2^32 messages.
+ */
+namespace Rotating {
+constexpr unsigned char		Label[]		{ 'C', 'h', 'R' };
+constexpr std::size_t		HeaderSize	{ 1 };
+
+template <typename N> constexpr std::uint64_t maximumMessages() noexcept
+{
+    return N::SequentialSize >= 8 ? ~std::uint64_t { 0 } : (std::uint64_t { 1 } << (8 * N::SequentialSize)) - 1;
+}
+template <typename N> constexpr std::uint64_t defaultMessages() noexcept
+{
+    return maximumMessages<N>() < std::uint64_t { 1 } << 32 ? maximumMessages<N>() : std::uint64_t { 1 } << 32;
+}
+
+template <std::size_t KS> void derive(SecretKeyBase<KS>& next_, const SecretKeyBase<KS>& current_, std::uint64_t epoch_) noexcept
+{
+    unsigned char data[sizeof(Label) + 8];
+    unsigned char* p { std::copy(std::begin(Label), std::end(Label), data) };
+    for(std::size_t i { 0 }; i != 8; ++i)
+	*p++= static_cast<unsigned char>(epoch_ >> (8 * i));
+    SizedHash<Operation::GenericHashBlake2b, KS> hash { current_, data, sizeof(data) };
+    std::copy(hash.begin(), hash.end(), next_.begin());
+    hash.clear();
+}
+
+template <Operation O, std::size_t S, bool = OperationTraits<O>::HasSecretBox> struct Types {
+    typedef BoxSealer<O, S>					SealerType;
+    typedef BoxOpener<O, S>					OpenerType;
+};
+template <Operation O, std::size_t S> struct Types<O, S, false> {
+    typedef AuthEncAdDataSealer<O, S>				SealerType;
+    typedef AuthEncAdDataOpener<O, S>				OpenerType;
+};
+
+/*
+ * Epochs. The keys and sealers or openers T of the current and the next epoch. A background thread
+ * derives the next epoch's key, sets up its T and tears down the previous one as soon as an epoch
+ * starts, so advance() only flips between the two. Should the thread fail, next() prepares inline.
+ */
+template <typename T, typename K, typename N> class Epochs {
+public:
+    template <typename B> Epochs(const B& k_, N& n_)
+	: _nonce	{ n_ }
+	, _current	{ 0 }
+	, _epoch	{ 0 }
+	, _ready	{ false }
+	, _helping	{ true }
+	, _stop		{ false }
+    {
+	std::copy(k_.begin(), k_.end(), _keys[0].begin());
+	_objects[0].reset(new T(_keys[0], _nonce));
+	_thread= std::thread(&Epochs::_help, this);
+    }
+    Epochs(const Epochs&) = delete;
+    Epochs(Epochs&&) = delete;
+    ~Epochs() noexcept
+    {
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    _stop= true;
+	}
+	_wanted.notify_one();
+	_thread.join();
+    }
+
+    Epochs& operator = (const Epochs&) = delete;
+    Epochs& operator = (Epochs&&) = delete;
+
+    T& current() const noexcept					{ return *_objects[_current]; }
+    // Waits for the background thread only if it hasn't finished preparing yet.
+    T& next()
+    {
+	std::unique_lock<std::mutex> lock { _mutex };
+	_prepared.wait(lock, [this]() { return _ready || !_helping; });
+	if(!_ready)
+	{
+	    _prepare(_current ^ 1, _epoch + 1);
+	    _ready= true;
+	}
+	return *_objects[_current ^ 1];
+    }
+    void advance()
+    {
+	next();
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    _current^= 1;
+	    _ready= false;
+	    ++_epoch;
+	}
+	_wanted.notify_one();
+    }
+
+    std::uint64_t epoch() const noexcept			{ return _epoch; }
+
+private:
+    N&							_nonce;
+    K							_keys[2];
+    std::unique_ptr<T>					_objects[2];
+    unsigned						_current;
+    std::uint64_t					_epoch;
+    bool						_ready;
+    bool						_helping;
+    bool						_stop;
+    std::mutex						_mutex;
+    std::condition_variable				_wanted;
+    std::condition_variable				_prepared;
+    std::thread						_thread;
+
+    // Replaces the previous epoch's key and T in slot next_ by those of epoch_.
+    void _prepare(unsigned next_, std::uint64_t epoch_)
+    {
+	_objects[next_].reset();
+	derive(_keys[next_], _keys[next_ ^ 1], epoch_);
+	_objects[next_].reset(new T(_keys[next_], _nonce));
+    }
+    void _help() noexcept
+    {
+	std::unique_lock<std::mutex> lock { _mutex };
+	for(;;)
+	{
+	    _wanted.wait(lock, [this]() { return _stop || !_ready; });
+	    if(_stop)
+		break;
+	    const unsigned next { _current ^ 1 };
+	    const std::uint64_t epoch { _epoch + 1 };
+	    lock.unlock();
+	    try {
+		_prepare(next, epoch);
+	    }
+	    catch(...)
+	    {
+		lock.lock();
+		_helping= false;	// Stop helping, next() prepares inline from now on.
+		_prepared.notify_one();
+		break;
+	    }
+	    lock.lock();
+	    _ready= true;
+	    _prepared.notify_one();
+	}
+    }
+};
+
+} // namespace Rotating
+
+/*
+ * RotatingSealer. Seals with the key of the current epoch and the nonce member. The next epoch's key
+ * and sealer are prepared by a background thread while the current epoch runs, so switching only
+ * flips to them and restarts the Nonce.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize> class RotatingSealer {
+    static_assert(OperationTraits<O>::HasSecretBox || OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal RotatingSealer type!");
+public:
+    typedef typename Rotating::Types<O, S>::SealerType		SealerType;
+
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ Rotating::HeaderSize + SealerType::Overhead };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    NonceType&						nonce;
+    const std::uint64_t					messageBudget;
+    const std::uint64_t					byteBudget;
+
+    // A byteBudget_ of 0 means no byte budget.
+    RotatingSealer(const SecretKeyBaseType& sk_, NonceType& n_, std::uint64_t messageBudget_ = Rotating::defaultMessages<NonceType>(),
+		   std::uint64_t byteBudget_ = 0)
+	: nonce		{ n_ }
+	, messageBudget	{ _checkedMessageBudget(messageBudget_) }
+	, byteBudget	{ byteBudget_ }
+	, _epochs	{ sk_, n_ }
+	, _messages	{ 0 }
+	, _bytes	{ 0 }
+    {}
+    RotatingSealer(const RotatingSealer&) = delete;
+    RotatingSealer(RotatingSealer&&) = delete;
+
+    RotatingSealer& operator = (const RotatingSealer&) = delete;
+    RotatingSealer& operator = (RotatingSealer&&) = delete;
+
+    std::string operator () (const std::string& message_)
+    {
+	std::string result(message_.length() + Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	if(_messages == messageBudget || (byteBudget != 0 && _messages != 0 && (_bytes >= byteBudget || byteBudget - _bytes < mN_)))
+	    _switch();
+	*cP_= static_cast<unsigned char>(_epochs.epoch());
+	const std::size_t result { _epochs.current()(mP_, mN_, cP_ + Rotating::HeaderSize, cN_ - Rotating::HeaderSize) };
+	++_messages;
+	_bytes+= mN_;
+	return result + Rotating::HeaderSize;
+    }
+
+    std::uint64_t epoch() const noexcept			{ return _epochs.epoch(); }
+
+private:
+    Rotating::Epochs<SealerType, SecretKeyType, NonceType>	_epochs;
+    std::uint64_t					_messages;
+    std::uint64_t					_bytes;
+
+    // Checks the message budget before the Epochs start their thread.
+    static std::uint64_t _checkedMessageBudget(std::uint64_t messageBudget_)
+    {
+	if(messageBudget_ == 0 || messageBudget_ > Rotating::maximumMessages<NonceType>())
+	    throw Exception(Exception::SizeMsg);
+	return messageBudget_;
+    }
+    void _switch()
+    {
+	_epochs.advance();
+	_messages= 0;
+	_bytes= 0;
+	nonce= NonceType(nonce.constantBegin(), nonce.constantEnd(), Tag::SpecifyConstant);
+    }
+};
+
+/*
+ * RotatingOpener. Opens RotatingSealer cyphers of the current epoch and moves on to the next epoch
+ * with the first cypher of it that verifies, forged epoch bytes leave it where it is. The next epoch
+ * is prepared in the background as in RotatingSealer.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize> class RotatingOpener {
+    static_assert(OperationTraits<O>::HasSecretBox || OperationTraits<O>::AuthEncAdDataSize > 0, "Illegal RotatingOpener type!");
+public:
+    typedef typename Rotating::Types<O, S>::OpenerType		OpenerType;
+
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ S };
+    constexpr static std::size_t			Overhead		{ Rotating::HeaderSize + OpenerType::Overhead };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    NonceType&						nonce;
+
+    RotatingOpener(const SecretKeyBaseType& sk_, NonceType& n_)
+	: nonce		{ n_ }
+	, _epochs	{ sk_, _unused }
+    {}
+    RotatingOpener(const RotatingOpener&) = delete;
+    RotatingOpener(RotatingOpener&&) = delete;
+
+    RotatingOpener& operator = (const RotatingOpener&) = delete;
+    RotatingOpener& operator = (RotatingOpener&&) = delete;
+
+    std::string operator () (const std::string& cypher_)
+    {
+	if(cypher_.length() < Overhead)
+	    throw VerificationError();
+	std::string result(cypher_.length() - Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&cypher_[0]), cypher_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	if(cN_ < Overhead)
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+	const unsigned char* const p { cP_ + Rotating::HeaderSize };
+	const std::size_t n { cN_ - Rotating::HeaderSize };
+	if(*cP_ == static_cast<unsigned char>(_epochs.epoch()))
+	{
+	    if(!_epochs.current()(nonce, p, n, mP_, std::nothrow))
+		throw VerificationError();
+	    ++nonce;
+	}
+	else if(*cP_ == static_cast<unsigned char>(_epochs.epoch() + 1))
+	{
+	    NonceType restart { nonce.constantBegin(), nonce.constantEnd(), Tag::SpecifyConstant };
+	    if(!_epochs.next()(restart, p, n, mP_, std::nothrow))
+		throw VerificationError();
+	    _epochs.advance();
+	    nonce= ++restart;
+	}
+	else
+	    throw VerificationError();
+	return cN_ - Overhead;
+    }
+
+    std::uint64_t epoch() const noexcept			{ return _epochs.epoch(); }
+
+private:
+    NonceType						_unused;
+    Rotating::Epochs<OpenerType, SecretKeyType, NonceType>	_epochs;
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOROTATING_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -0,0 +1,315 @@
+/*
+** CryptoSealedBox.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CHLORIDE_CRYPTOSEALEDBOX_H_
+#define CHLORIDE_CRYPTOSEALEDBOX_H_
+
+#include <sodium/crypto_generichash_blake2b.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CryptoBox.h"
+
+namespace Crypto {
+/*
+ * EphemeralKeyPool. Keeps up to capacity pre-generated Box KeyPairs in one locked region, a
+ * background thread refills it. Every KeyPair is handed out once and wiped from the pool.
+ */
+template <Operation O> class EphemeralKeyPool {
+    static_assert(OperationTraits<O>::HasBox, "Illegal EphemeralKeyPool type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			PublicKeySize		{ OperationTraits<Oper>::PublicKeySize };
+    constexpr static std::size_t			SecretKeySize		{ OperationTraits<Oper>::SecretKeySize };
+    constexpr static std::size_t			Size			{ PublicKeySize + SecretKeySize };
+
+    typedef KeyPair<Oper>					KeyPairType;
+
+    explicit EphemeralKeyPool(std::size_t capacity_)
+	: _capacity	{ capacity_ }
+	, _keys		{ new(Memory::Allocate) unsigned char[capacity_ * Size] }
+	, _size		{ 0 }
+	, _stop		{ false }
+	, _thread	{ &EphemeralKeyPool::_refill, this }
+    {}
+    EphemeralKeyPool(const EphemeralKeyPool&) = delete;
+    EphemeralKeyPool(EphemeralKeyPool&&) = delete;
+    ~EphemeralKeyPool() noexcept
+    {
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    _stop= true;
+	}
+	_wanted.notify_one();
+	_thread.join();
+    }
+
+    EphemeralKeyPool& operator = (const EphemeralKeyPool&) = delete;
+    EphemeralKeyPool& operator = (EphemeralKeyPool&&) = delete;
+
+    /*
+     * Generates the KeyPair in the calling thread when the pool has run dry.
+     */
+    KeyPairType& operator () (KeyPairType& kp_)
+    {
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    if(_size > 0)
+	    {
+		unsigned char* slot { _keys.get() + --_size * Size };
+		std::copy_n(slot, PublicKeySize, kp_.publicKey.begin());
+		std::copy_n(slot + PublicKeySize, SecretKeySize, kp_.secretKey.begin());
+		::sodium_memzero(slot, Size);
+		_wanted.notify_one();
+		return kp_;
+	    }
+	}
+	_wanted.notify_one();
+	_generate(kp_);
+	return kp_;
+    }
+
+    std::size_t capacity() const noexcept			{ return _capacity; }
+    std::size_t size() noexcept
+    {
+	std::lock_guard<std::mutex> lock { _mutex };
+	return _size;
+    }
+
+private:
+    const std::size_t					_capacity;
+    std::unique_ptr<unsigned char[], Memory::Free>	_keys;
+    std::size_t						_size;
+    bool						_stop;
+    std::mutex						_mutex;
+    std::condition_variable				_wanted;
+    std::thread						_thread;
+
+    static void _generate(KeyPairType& kp_)
+    {
+	if(::crypto_box_curve25519xsalsa20poly1305_keypair(kp_.publicKey.begin(), kp_.secretKey.begin()))
+	    throw Exception(Exception::KeyGenMsg);
+    }
+    void _refill() noexcept
+    {
+	try {
+	    KeyPairType keys;
+	    std::unique_lock<std::mutex> lock { _mutex };
+	    for(;;)
+	    {
+		_wanted.wait(lock, [this]() { return _stop || _size < _capacity; });
+		if(_stop)
+		    break;
+		lock.unlock();
+		_generate(keys);
+		lock.lock();
+		if(_size < _capacity)
+		{
+		    unsigned char* slot { _keys.get() + _size++ * Size };
+		    std::copy(keys.publicKey.begin(), keys.publicKey.end(), slot);
+		    std::copy(keys.secretKey.begin(), keys.secretKey.end(), slot + PublicKeySize);
+		}
+	    }
+	}
+	catch(...)
+	{}	// Stop refilling, consumers generate their own KeyPairs.
+    }
+};
+
+/*
+ * SealedBoxSealer. Anonymous Box to a recipient's PublicKey, compatible with crypto_box_seal: a fresh
+ * ephemeral KeyPair per message, the Nonce is the BLAKE2b hash of both public keys and the cypher
+ * is the ephemeral PublicKey followed by the Box. The shared key goes through one locked buffer that
+ * is wiped after every message, so a seal costs the X25519 DH and the symmetric work only.
+ */
+template <Operation O> class SealedBoxSealer {
+    static_assert(OperationTraits<O>::HasBox, "Illegal SealedBoxSealer type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			Overhead		{ OperationTraits<Oper>::PublicKeySize
+										  + BoxSealer<Oper>::Overhead };
+
+    typedef PublicKey<Oper>					PublicKeyType;
+    typedef KeyPair<Oper>					KeyPairType;
+    typedef EphemeralKeyPool<Oper>				KeyPoolType;
+
+    const PublicKeyType&				publicKey;
+
+    explicit SealedBoxSealer(const PublicKeyType& pk_)
+	: publicKey	{ pk_ }
+	, _pool		{ nullptr }
+    {
+	_lock(_shared);
+    }
+    SealedBoxSealer(KeyPoolType& p_, const PublicKeyType& pk_)
+	: publicKey	{ pk_ }
+	, _pool		{ &p_ }
+    {
+	_lock(_shared);
+    }
+    SealedBoxSealer(const SealedBoxSealer&) = delete;
+    SealedBoxSealer(SealedBoxSealer&&) = delete;
+    ~SealedBoxSealer() noexcept
+    {
+	::sodium_munlock(_shared, SharedSize);
+    }
+
+    SealedBoxSealer& operator = (const SealedBoxSealer&) = delete;
+    SealedBoxSealer& operator = (SealedBoxSealer&&) = delete;
+
+    std::string operator () (const std::string& message_)
+    {
+	std::string result(message_.length() + Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&message_[0]), message_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::string operator () (const std::vector<Segment>& message_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t n { _scratch(message_.data(), message_.data() + message_.size()) };
+	std::string result(n + Overhead, '\0');
+	operator()(_scratch.begin(), n, reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const Segment* begin_, const Segment* end_, unsigned char* cP_, std::size_t cN_)
+    {
+	const Memory::Scratch::Wipe wipe { _scratch };
+	const std::size_t n { _scratch(begin_, end_) };
+	return operator()(_scratch.begin(), n, cP_, cN_);
+    }
+    std::size_t operator () (const unsigned char* mP_, std::size_t mN_, unsigned char* cP_, std::size_t cN_)
+    {
+	if(cN_ < mN_ + Overhead)
+	    throw Exception(Exception::SizeMsg);
+	if(_pool)
+	    (*_pool)(_ephemeral);
+	else if(::crypto_box_curve25519xsalsa20poly1305_keypair(_ephemeral.publicKey.begin(), _ephemeral.secretKey.begin()))
+	    throw Exception(Exception::KeyGenMsg);
+	typename BoxSealer<Oper>::NonceType nonce;
+	_sealedNonce(nonce, _ephemeral.publicKey, publicKey);
+	::crypto_box_curve25519xsalsa20poly1305_beforenm(_shared, publicKey.begin(), _ephemeral.secretKey.begin());
+	_ephemeral.secretKey.clear();
+	std::copy(_ephemeral.publicKey.begin(), _ephemeral.publicKey.end(), cP_);
+	::crypto_box_easy_afternm(cP_ + PublicKeyType::Size, mP_, mN_, nonce.begin(), _shared);
+	::sodium_memzero(_shared, SharedSize);
+	return mN_ + Overhead;
+    }
+
+private:
+    template <Operation> friend class SealedBoxOpener;
+
+    constexpr static std::size_t			SharedSize		{ OperationTraits<Oper>::IntermediateSize };
+
+    KeyPoolType*					_pool;
+    KeyPairType						_ephemeral;
+    unsigned char					_shared[SharedSize];
+    Memory::Scratch					_scratch;
+
+    static void _lock(unsigned char* p_)
+    {
+	if(::sodium_mlock(p_, SharedSize))
+	    throw Exception(Exception::LockMsg);
+    }
+
+    template <typename N> static void _sealedNonce(N& n_, const PublicKeyType& epk_, const PublicKeyType& pk_) noexcept
+    {
+	::crypto_generichash_blake2b_state state;
+	::crypto_generichash_blake2b_init(&state, nullptr, 0, N::Size);
+	::crypto_generichash_blake2b_update(&state, epk_.begin(), PublicKeyType::Size);
+	::crypto_generichash_blake2b_update(&state, pk_.begin(), PublicKeyType::Size);
+	::crypto_generichash_blake2b_final(&state, n_.begin(), N::Size);
+    }
+};
+
+/*
+ * SealedBoxOpener. Opens SealedBoxSealer and crypto_box_seal cyphers with the recipient's KeyPair.
+ */
+template <Operation O> class SealedBoxOpener {
+    static_assert(OperationTraits<O>::HasBox, "Illegal SealedBoxOpener type!");
+public:
+    constexpr static Operation 				Oper			{ O };
+    constexpr static std::size_t			Overhead		{ SealedBoxSealer<Oper>::Overhead };
+
+    typedef PublicKey<Oper>					PublicKeyType;
+    typedef KeyPair<Oper>					KeyPairType;
+
+    const KeyPairType&					keyPair;
+
+    explicit SealedBoxOpener(const KeyPairType& kp_)
+	: keyPair	{ kp_ }
+    {
+	SealedBoxSealer<Oper>::_lock(_shared);
+    }
+    SealedBoxOpener(const SealedBoxOpener&) = delete;
+    SealedBoxOpener(SealedBoxOpener&&) = delete;
+    ~SealedBoxOpener() noexcept
+    {
+	::sodium_munlock(_shared, SharedSize);
+    }
+
+    SealedBoxOpener& operator = (const SealedBoxOpener&) = delete;
+    SealedBoxOpener& operator = (SealedBoxOpener&&) = delete;
+
+    std::string operator () (const std::string& cypher_)
+    {
+	if(cypher_.length() < Overhead)
+	    throw VerificationError();
+	std::string result(cypher_.length() - Overhead, '\0');
+	operator()(reinterpret_cast<const unsigned char*>(&cypher_[0]), cypher_.length(),
+		   reinterpret_cast<unsigned char*>(&result[0]), result.length());
+	return result;
+    }
+    std::size_t operator () (const unsigned char* cP_, std::size_t cN_, unsigned char* mP_, std::size_t mN_)
+    {
+	if(cN_ < Overhead)
+	    throw VerificationError();
+	if(mN_ < cN_ - Overhead)
+	    throw Exception(Exception::SizeMsg);
+	const PublicKeyType ephemeral { cP_, cP_ + PublicKeyType::Size };
+	typename BoxOpener<Oper>::NonceType nonce;
+	SealedBoxSealer<Oper>::_sealedNonce(nonce, ephemeral, keyPair.publicKey);
+	::crypto_box_curve25519xsalsa20poly1305_beforenm(_shared, ephemeral.begin(), keyPair.secretKey.begin());
+	const bool opened { ::crypto_box_open_easy_afternm(mP_, cP_ + PublicKeyType::Size, cN_ - PublicKeyType::Size, nonce.begin(), _shared) == 0 };
+	::sodium_memzero(_shared, SharedSize);
+	if(!opened)
+	    throw VerificationError();
+	return cN_ - Overhead;
+    }
+
+private:
+    constexpr static std::size_t			SharedSize		{ SealedBoxSealer<Oper>::SharedSize };
+
+    unsigned char					_shared[SharedSize];
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOSEALEDBOX_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -32,8 +32,16 @@
 #include <sodium/crypto_stream_chacha20.h>
 #include <sodium/crypto_stream_xsalsa20.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "CryptoMemory.h"
 #include "CryptoSecretKey.h"
 #include "CryptoNonce.h"
+#include "CryptoThreadPool.h"
 
 namespace Crypto {
 /*
@@ -173,7 +181,69 @@ template <> struct OperationTraits<Operation::StreamXsalsa20> {
 };
 
 /*
- * Streamer. Stream xoring happens in place because NaCl/sodium does it this way itself.
+ * Keystream. Fills p_ with n_ bytes of keystream of a stream Operation.
+ */
+template <Operation O> void keystream(unsigned char* p_, std::size_t n_, const unsigned char* nonce_, const unsigned char* secretKey_)
+{
+    static_assert(OperationTraits<O>::HasStream, "Illegal keystream type!");
+    switch(O) {
+    case Operation::StreamAes128ctr:
+	::crypto_stream_aes128ctr(p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamSalsa20:
+	::crypto_stream_salsa20(p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamSalsa208:
+	::crypto_stream_salsa208(p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamSalsa2012:
+	::crypto_stream_salsa2012(p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamChacha20:
+	::crypto_stream_chacha20(p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamXsalsa20:
+	::crypto_stream_xsalsa20(p_, n_, nonce_, secretKey_);
+	break;
+    default:
+	throw Exception(Exception::ImplMsg);
+    }
+}
+
+/*
+ * Stream xor. Xors n_ bytes at p_ in place with the keystream of a stream Operation.
+ */
+template <Operation O> void streamXor(unsigned char* p_, std::size_t n_, const unsigned char* nonce_, const unsigned char* secretKey_)
+{
+    static_assert(OperationTraits<O>::HasStream, "Illegal streamXor type!");
+    switch(O) {
+    case Operation::StreamAes128ctr:
+	::crypto_stream_aes128ctr_xor(p_, p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamSalsa20:
+	::crypto_stream_salsa20_xor(p_, p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamSalsa208:
+	::crypto_stream_salsa208_xor(p_, p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamSalsa2012:
+	::crypto_stream_salsa2012_xor(p_, p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamChacha20:
+	::crypto_stream_chacha20_xor(p_, p_, n_, nonce_, secretKey_);
+	break;
+    case Operation::StreamXsalsa20:
+	::crypto_stream_xsalsa20_xor(p_, p_, n_, nonce_, secretKey_);
+	break;
+    default:
+	throw Exception(Exception::ImplMsg);
+    }
+}
+
+/*
+ * Streamer. Stream xoring happens in place because NaCl/sodium does it this way itself, a pad of
+ * keystream at a time through Memory::xorBytes. Every pad has its own Nonce, so the ThreadPool
+ * variant can spread whole pads over threads.
  */
 constexpr std::size_t StreamerDefaultPadSize	{ 0x10000 };
 
@@ -206,46 +276,361 @@ public:
 
     void operator () (std::string& messageOrCypher_)
     {
-	auto i { messageOrCypher_.begin() };
-	while(i != messageOrCypher_.end())
+	operator()(reinterpret_cast<unsigned char*>(&messageOrCypher_[0]), messageOrCypher_.length());
+    }
+    void operator () (unsigned char* p_, std::size_t n_)
+    {
+	for(;;)
+	{
+	    const std::size_t n { std::min(n_, static_cast<std::size_t>(_bytes + Size - _at)) };
+	    Memory::xorBytes(p_, _at, n);
+	    p_+= n;
+	    n_-= n;
+	    _at+= n;
+	    if(n_ == 0)
+		break;
+	    _fill(_bytes, Size, nonce);
+	    _at= _bytes;
+	    ++nonce;
+	}
+    }
+
+    // Whole pads, each under its own Nonce, are xored concurrently; the result is identical to the sequential operator.
+    void operator () (ThreadPool& pool_, unsigned char* p_, std::size_t n_, std::size_t grain_ = 1)
+    {
+	const std::size_t head { std::min(n_, static_cast<std::size_t>(_bytes + Size - _at)) };
+	operator()(p_, head);
+	p_+= head;
+	n_-= head;
+	const std::size_t pads { n_ / Size };
+	if(pads != 0)
+	{
+	    const NonceType first { nonce };
+	    nonce+= pads;
+	    pool_(pads, grain_, [&](std::size_t b_, std::size_t e_) {
+		for(std::size_t i { b_ }; i != e_; ++i)
+		    _xor(p_ + i * Size, Size, first + i);
+	    });
+	    p_+= pads * Size;
+	    n_-= pads * Size;
+	    _at= _bytes + Size;
+	}
+	operator()(p_, n_);
+    }
+
+    void forceUpdate() noexcept					{ _at= _bytes + Size; }
+
+private:
+    unsigned char*					_at;
+    unsigned char					_bytes[Size];
+
+    void _xor(unsigned char* p_, std::size_t n_, const NonceType& nonce_) const
+    {
+	streamXor<Oper>(p_, n_, nonce_.begin(), secretKey.begin());
+    }
+
+    void _fill(unsigned char* p_, std::size_t n_, const NonceType& nonce_) const
+    {
+	keystream<Oper>(p_, n_, nonce_.begin(), secretKey.begin());
+    }
+};
+
+/*
+ * PooledStreamer. Streamer whose pad is a slot of a Memory::Pool, so the pad size is chosen at
+ * runtime by the Pool and the pad lives in locked memory that is wiped when the PooledStreamer goes.
+ * With the same pad size its output is identical to Streamer's.
+ */
+template <Operation O, std::size_t NSS = OperationTraits<O>::NonceDefaultSequentialSize>
+class PooledStreamer {
+    static_assert(OperationTraits<O>::HasStream, "Illegal PooledStreamer type!");
+public:
+    constexpr static Operation				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ NSS };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    NonceType&						nonce;
+    const SecretKeyBaseType&				secretKey;
+
+    PooledStreamer(Memory::Pool& p_, const SecretKeyBaseType& sk_, NonceType& n_)
+	: nonce		{ n_ }
+	, secretKey	{ sk_ }
+	, _pool		{ p_ }
+	, _bytes	{ p_.allocate() }
+	, _at		{ _bytes + size() }
+    {}
+    PooledStreamer(const PooledStreamer&) = delete;
+    PooledStreamer(PooledStreamer&&) = delete;
+    ~PooledStreamer() noexcept					{ _pool.release(_bytes); }
+
+    PooledStreamer& operator = (const PooledStreamer&) = delete;
+    PooledStreamer& operator = (PooledStreamer&&) = delete;
+
+    void operator () (std::string& messageOrCypher_)
+    {
+	operator()(reinterpret_cast<unsigned char*>(&messageOrCypher_[0]), messageOrCypher_.length());
+    }
+    void operator () (unsigned char* p_, std::size_t n_)
+    {
+	for(;;)
 	{
-	    for(const auto end { i +  std::min(messageOrCypher_.end() - i, _bytes + Size - _at) }; i != end; ++i, ++_at)
-		*i^= *_at;
-	    if(i != messageOrCypher_.end())
+	    const std::size_t n { std::min(n_, static_cast<std::size_t>(_bytes + size() - _at)) };
+	    Memory::xorBytes(p_, _at, n);
+	    p_+= n;
+	    n_-= n;
+	    _at+= n;
+	    if(n_ == 0)
+		break;
+	    keystream<Oper>(_bytes, size(), nonce.begin(), secretKey.begin());
+	    _at= _bytes;
+	    ++nonce;
+	}
+    }
+
+    std::size_t size() const noexcept				{ return _pool.slotSize(); }
+
+    void forceUpdate() noexcept					{ _at= _bytes + size(); }
+
+private:
+    Memory::Pool&					_pool;
+    unsigned char*					_bytes;
+    unsigned char*					_at;
+};
+
+/*
+ * PrefetchStreamer. Streamer with a second pad that a background thread generates under the next
+ * Nonce while the current one is being used, so a call crossing a pad boundary swaps pads instead
+ * of waiting for keystream. The output is identical to Streamer's; the Nonce must not be changed
+ * from outside while the PrefetchStreamer lives.
+ */
+template <Operation O, std::size_t S = StreamerDefaultPadSize, std::size_t NSS = OperationTraits<O>::NonceDefaultSequentialSize>
+class PrefetchStreamer {
+    static_assert(OperationTraits<O>::HasStream, "Illegal PrefetchStreamer type!");
+public:
+    constexpr static Operation				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ NSS };
+    constexpr static std::size_t			Size			{ S };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    const NonceType&					nonce;
+    const SecretKeyBaseType&				secretKey;
+
+    PrefetchStreamer(const SecretKeyBaseType& sk_, NonceType& n_)
+	: nonce		{ n_ }
+	, secretKey	{ sk_ }
+	, _nonce	{ n_ }
+	, _ahead	{ n_ }
+	, _pads		{ new(Memory::Allocate) unsigned char[2 * Size] }
+	, _current	{ _pads.get() }
+	, _spare	{ _pads.get() + Size }
+	, _at		{ _current + Size }
+	, _ready	{ false }
+	, _failed	{ false }
+	, _stop		{ false }
+	, _thread	{ &PrefetchStreamer::_prefetch, this }
+    {}
+    PrefetchStreamer(const PrefetchStreamer&) = delete;
+    PrefetchStreamer(PrefetchStreamer&&) = delete;
+    ~PrefetchStreamer() noexcept
+    {
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    _stop= true;
+	}
+	_changed.notify_one();
+	_thread.join();
+    }
+
+    PrefetchStreamer& operator = (const PrefetchStreamer&) = delete;
+    PrefetchStreamer& operator = (PrefetchStreamer&&) = delete;
+
+    void operator () (std::string& messageOrCypher_)
+    {
+	operator()(reinterpret_cast<unsigned char*>(&messageOrCypher_[0]), messageOrCypher_.length());
+    }
+    void operator () (unsigned char* p_, std::size_t n_)
+    {
+	for(;;)
+	{
+	    const std::size_t n { std::min(n_, static_cast<std::size_t>(_current + Size - _at)) };
+	    Memory::xorBytes(p_, _at, n);
+	    p_+= n;
+	    n_-= n;
+	    _at+= n;
+	    if(n_ == 0)
+		break;
+	    _next();
+	}
+    }
+
+private:
+    NonceType&						_nonce;
+    NonceType						_ahead;
+    std::unique_ptr<unsigned char[], Memory::Free>	_pads;
+    unsigned char*					_current;
+    unsigned char*					_spare;
+    unsigned char*					_at;
+    bool						_ready;
+    bool						_failed;
+    bool						_stop;
+    std::mutex						_mutex;
+    std::condition_variable				_changed;
+    std::thread						_thread;
+
+    // Takes the prefetched pad, or generates it in the calling thread when the background thread has given up.
+    void _next()
+    {
+	{
+	    std::unique_lock<std::mutex> lock { _mutex };
+	    _changed.wait(lock, [this]() { return _ready || _failed; });
+	    if(_ready)
 	    {
-		switch(Oper) {
-		case Operation::StreamAes128ctr:
-		    ::crypto_stream_aes128ctr(reinterpret_cast<unsigned char*>(_bytes), Size, nonce.begin(), secretKey.begin());
-		    break;
-		case Operation::StreamSalsa20:
-		    ::crypto_stream_salsa20(reinterpret_cast<unsigned char*>(_bytes), Size, nonce.begin(), secretKey.begin());
-		    break;
-		case Operation::StreamSalsa208:
-		    ::crypto_stream_salsa208(reinterpret_cast<unsigned char*>(_bytes), Size, nonce.begin(), secretKey.begin());
-		    break;
-		case Operation::StreamSalsa2012:
-		    ::crypto_stream_salsa2012(reinterpret_cast<unsigned char*>(_bytes), Size, nonce.begin(), secretKey.begin());
-		    break;
-		case Operation::StreamChacha20:
-		    ::crypto_stream_chacha20(reinterpret_cast<unsigned char*>(_bytes), Size, nonce.begin(), secretKey.begin());
-		    break;
-		case Operation::StreamXsalsa20:
-		    ::crypto_stream_xsalsa20(reinterpret_cast<unsigned char*>(_bytes), Size, nonce.begin(), secretKey.begin());
+		std::swap(_current, _spare);
+		_ready= false;
+	    }
+	    else
+		keystream<Oper>(_current, Size, _nonce.begin(), secretKey.begin());
+	}
+	_changed.notify_one();
+	_at= _current;
+	++_nonce;
+    }
+    void _prefetch() noexcept
+    {
+	try {
+	    std::unique_lock<std::mutex> lock { _mutex };
+	    for(;;)
+	    {
+		_changed.wait(lock, [this]() { return _stop || !_ready; });
+		if(_stop)
 		    break;
-		default:
-		    throw Exception(Exception::ImplMsg);
-		}
-		_at= _bytes;
-		++nonce;
+		unsigned char* spare { _spare };
+		lock.unlock();
+		keystream<Oper>(spare, Size, _ahead.begin(), secretKey.begin());
+		lock.lock();
+		_ready= true;
+		_changed.notify_one();
+		++_ahead;
 	    }
 	}
+	catch(...)
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    _failed= true;
+	    _changed.notify_one();
+	}
     }
+};
 
-    void forceUpdate() noexcept					{ _at= _bytes + Size; }
+/*
+ * Traits for Operations whose keystream can start at any 64 byte block through crypto_stream_*_xor_ic.
+ */
+template <Operation O> struct StreamCounterTraits {
+    constexpr static bool		HasCounter			{ false };
+};
+template <> struct StreamCounterTraits<Operation::StreamSalsa20> {
+    constexpr static bool		HasCounter			{ true };
+};
+template <> struct StreamCounterTraits<Operation::StreamChacha20> {
+    constexpr static bool		HasCounter			{ true };
+};
+template <> struct StreamCounterTraits<Operation::StreamXsalsa20> {
+    constexpr static bool		HasCounter			{ true };
+};
+
+/*
+ * SeekableStreamer. Xors in place at a byte offset into a single keystream, so seek is O(1) and any
+ * range of a large cypher can be decrypted without regenerating the keystream in front of it.
+ * Unlike Streamer the Nonce is never incremented: one Nonce covers the whole 2^64 block stream.
+ */
+template <Operation O, std::size_t NSS = OperationTraits<O>::NonceDefaultSequentialSize>
+class SeekableStreamer {
+    static_assert(OperationTraits<O>::HasStream && StreamCounterTraits<O>::HasCounter, "Illegal SeekableStreamer type!");
+public:
+    constexpr static Operation				Oper			{ O };
+    constexpr static std::size_t			NonceSequentialSize	{ NSS };
+    constexpr static std::size_t			BlockSize		{ 64 };
+
+    typedef Nonce<Oper, NonceSequentialSize>			NonceType;
+    typedef SecretKey<Oper>					SecretKeyType;
+    typedef SecretKeyBase<OperationTraits<Oper>::SecretKeySize>	SecretKeyBaseType;
+
+    const NonceType&					nonce;
+    const SecretKeyBaseType&				secretKey;
+
+    SeekableStreamer(const SecretKeyBaseType& sk_, const NonceType& n_, std::uint64_t offset_ = 0) noexcept
+	: nonce		{ n_ }
+	, secretKey	{ sk_ }
+	, _offset	{ offset_ }
+    {}
+
+    SeekableStreamer(const SeekableStreamer&) = delete;
+    SeekableStreamer(SeekableStreamer&&) = delete;
+
+    SeekableStreamer& operator = (const SeekableStreamer&) = delete;
+    SeekableStreamer& operator = (SeekableStreamer&&) = delete;
+
+    void operator () (std::string& messageOrCypher_)
+    {
+	operator()(reinterpret_cast<unsigned char*>(&messageOrCypher_[0]), messageOrCypher_.length());
+    }
+    void operator () (unsigned char* p_, std::size_t n_)
+    {
+	if(n_ > ~_offset)
+	    throw Exception(Exception::OverflowMsg);
+	const std::size_t skip { static_cast<std::size_t>(_offset % BlockSize) };
+	if(skip != 0 && n_ != 0)
+	{
+	    // Xor the head up to the next block boundary through a whole block of keystream.
+	    unsigned char block[BlockSize] {};
+	    const std::size_t n { std::min(n_, BlockSize - skip) };
+	    std::copy(p_, p_ + n, block + skip);
+	    _xor(block, BlockSize, _offset / BlockSize);
+	    std::copy(block + skip, block + skip + n, p_);
+	    ::sodium_memzero(block, BlockSize);
+	    p_+= n;
+	    n_-= n;
+	    _offset+= n;
+	}
+	if(n_ != 0)
+	{
+	    _xor(p_, n_, _offset / BlockSize);
+	    _offset+= n_;
+	}
+    }
+    void operator () (std::uint64_t offset_, unsigned char* p_, std::size_t n_)
+    {
+	seek(offset_);
+	operator()(p_, n_);
+    }
+
+    void seek(std::uint64_t offset_) noexcept			{ _offset= offset_; }
+    std::uint64_t tell() const noexcept				{ return _offset; }
 
 private:
-    char*						_at;
-    char						_bytes[Size];
+    std::uint64_t					_offset;
+
+    void _xor(unsigned char* p_, std::size_t n_, std::uint64_t block_) const
+    {
+	switch(Oper) {
+	case Operation::StreamSalsa20:
+	    ::crypto_stream_salsa20_xor_ic(p_, p_, n_, nonce.begin(), block_, secretKey.begin());
+	    break;
+	case Operation::StreamChacha20:
+	    ::crypto_stream_chacha20_xor_ic(p_, p_, n_, nonce.begin(), block_, secretKey.begin());
+	    break;
+	case Operation::StreamXsalsa20:
+	    ::crypto_stream_xsalsa20_xor_ic(p_, p_, n_, nonce.begin(), block_, secretKey.begin());
+	    break;
+	default:
+	    throw Exception(Exception::ImplMsg);
+	}
+    }
 };
 
 } // namespace Crypto
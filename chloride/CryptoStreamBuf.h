@@ -0,0 +1,300 @@
+/*
+** CryptoStreamBuf.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHLORIDE_CRYPTOSTREAMBUF_H_
+#define CHLORIDE_CRYPTOSTREAMBUF_H_
+
+#include <ios>
+#include <streambuf>
+
+#include "CryptoChunked.h"
+#include "CryptoStream.h"
+
+namespace Crypto {
+constexpr std::size_t StreamBufDefaultSize	{ 0x10000 };
+
+namespace Chunked {
+/*
+ * The chunked sealer and opener of an Operation: SecretBox or AuthEncAdData.
+ */
+template <Operation O, std::size_t S, bool = OperationTraits<O>::HasSecretBox> struct Types {
+    typedef ChunkedSealer<O, S>					SealerType;
+    typedef ChunkedOpener<O, S>					OpenerType;
+};
+template <Operation O, std::size_t S> struct Types<O, S, false> {
+    typedef ChunkedAuthEncAdDataSealer<O, S>			SealerType;
+    typedef ChunkedAuthEncAdDataOpener<O, S>			OpenerType;
+};
+
+} // namespace Chunked
+
+/*
+ * StreamerBuf. std::streambuf that xors everything passing through it with a Streamer, PooledStreamer
+ * or PrefetchStreamer before handing it to, or after taking it from, another std::streambuf. The
+ * Streamer has a single position, so a StreamerBuf either writes (std::ios_base::out) or reads
+ * (std::ios_base::in). Its buffer is locked and wiped.
+ */
+template <typename St> class StreamerBuf : public std::streambuf {
+public:
+    typedef St							StreamerType;
+
+    StreamerType&					streamer;
+
+    StreamerBuf(StreamerType& streamer_, std::streambuf& target_, std::ios_base::openmode mode_ = std::ios_base::out,
+		std::size_t size_ = StreamBufDefaultSize)
+	: streamer	{ streamer_ }
+	, _target	{ target_ }
+	, _out		{ (mode_ & std::ios_base::out) != 0 }
+	, _size		{ size_ }
+	, _bytes	{ new(Memory::Allocate) unsigned char[size_] }
+    {
+	if(_size == 0 || ((mode_ & std::ios_base::in) != 0) == _out)
+	    throw Exception(Exception::SizeMsg);
+	if(_out)
+	    setp(_begin(), _begin() + _size);
+	else
+	    setg(_begin(), _begin(), _begin());
+    }
+    StreamerBuf(const StreamerBuf&) = delete;
+    StreamerBuf(StreamerBuf&&) = delete;
+    ~StreamerBuf() noexcept
+    {
+	try {
+	    sync();
+	}
+	catch(...)
+	{}
+    }
+
+    StreamerBuf& operator = (const StreamerBuf&) = delete;
+    StreamerBuf& operator = (StreamerBuf&&) = delete;
+
+protected:
+    int_type overflow(int_type c_) override
+    {
+	if(!_out || !_flush())
+	    return traits_type::eof();
+	if(!traits_type::eq_int_type(c_, traits_type::eof()))
+	{
+	    *pptr()= traits_type::to_char_type(c_);
+	    pbump(1);
+	}
+	return traits_type::not_eof(c_);
+    }
+    int sync() override
+    {
+	if(_out && !_flush())
+	    return -1;
+	return _target.pubsync();
+    }
+    int_type underflow() override
+    {
+	if(_out)
+	    return traits_type::eof();
+	::sodium_memzero(_bytes.get(), _size);
+	const std::streamsize n { _target.sgetn(_begin(), static_cast<std::streamsize>(_size)) };
+	if(n <= 0)
+	    return traits_type::eof();
+	streamer(_bytes.get(), static_cast<std::size_t>(n));
+	setg(_begin(), _begin(), _begin() + n);
+	return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::streambuf&					_target;
+    const bool						_out;
+    const std::size_t					_size;
+    std::unique_ptr<unsigned char[], Memory::Free>	_bytes;
+
+    char* _begin() const noexcept				{ return reinterpret_cast<char*>(_bytes.get()); }
+    bool _flush()
+    {
+	const std::streamsize n { pptr() - pbase() };
+	streamer(_bytes.get(), static_cast<std::size_t>(n));
+	const bool result { _target.sputn(_begin(), n) == n };
+	::sodium_memzero(_bytes.get(), static_cast<std::size_t>(n));
+	setp(_begin(), _begin() + _size);
+	return result;
+    }
+};
+
+/*
+ * ChunkedSealerBuf. std::ostream side std::streambuf writing a ChunkedSealer blob, or a
+ * ChunkedAuthEncAdDataSealer stream for AuthEncAdData Operations, to another std::streambuf, one
+ * chunk at a time. A chunk is only sealed once it is known whether it is the final one, so the
+ * final chunk is written by close() or on destruction and sync() can't push out a partial chunk.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize>
+class ChunkedSealerBuf : public std::streambuf {
+public:
+    typedef typename Chunked::Types<O, S>::SealerType		SealerType;
+    typedef typename SealerType::SecretKeyBaseType		SecretKeyBaseType;
+
+    ChunkedSealerBuf(const SecretKeyBaseType& sk_, std::streambuf& target_, std::size_t chunkSize_ = Chunked::DefaultChunkSize)
+	: _sealer	{ sk_, chunkSize_ }
+	, _target	{ target_ }
+	, _buffer	{ new(Memory::Allocate) unsigned char[2 * chunkSize_ + SealerType::Overhead] }
+	, _chunks	{ 0 }
+	, _closed	{ false }
+    {
+	setp(_clear(), _clear() + _sealer.chunkSize);
+    }
+    ChunkedSealerBuf(const ChunkedSealerBuf&) = delete;
+    ChunkedSealerBuf(ChunkedSealerBuf&&) = delete;
+    ~ChunkedSealerBuf() noexcept
+    {
+	try {
+	    close();
+	}
+	catch(...)
+	{}
+    }
+
+    ChunkedSealerBuf& operator = (const ChunkedSealerBuf&) = delete;
+    ChunkedSealerBuf& operator = (ChunkedSealerBuf&&) = delete;
+
+    /*
+     * Seals and writes the final chunk, later output fails.
+     */
+    bool close()
+    {
+	if(_closed)
+	    return true;
+	_closed= true;
+	const bool result { _seal(true) };
+	setp(nullptr, nullptr);
+	return _target.pubsync() == 0 && result;
+    }
+
+protected:
+    int_type overflow(int_type c_) override
+    {
+	if(_closed)
+	    return traits_type::eof();
+	if(!traits_type::eq_int_type(c_, traits_type::eof()))
+	{
+	    if(pptr() == epptr() && !_seal(false))
+		return traits_type::eof();
+	    *pptr()= traits_type::to_char_type(c_);
+	    pbump(1);
+	}
+	return traits_type::not_eof(c_);
+    }
+    int sync() override
+    {
+	return _target.pubsync();
+    }
+
+private:
+    SealerType						_sealer;
+    std::streambuf&					_target;
+    std::unique_ptr<unsigned char[], Memory::Free>	_buffer;
+    std::uint64_t					_chunks;
+    bool						_closed;
+
+    char* _clear() const noexcept				{ return reinterpret_cast<char*>(_buffer.get()); }
+    unsigned char* _cypher() const noexcept			{ return _buffer.get() + _sealer.chunkSize; }
+    bool _seal(bool last_)
+    {
+	if(_chunks == 0)
+	{
+	    const std::streamsize n { static_cast<std::streamsize>(_sealer.header(_cypher())) };
+	    if(_target.sputn(reinterpret_cast<const char*>(_cypher()), n) != n)
+		return false;
+	}
+	const std::size_t n { static_cast<std::size_t>(pptr() - pbase()) };
+	const std::streamsize m { static_cast<std::streamsize>(_sealer.chunks(_chunks++, _buffer.get(), n, _cypher(), last_)) };
+	::sodium_memzero(_buffer.get(), n);
+	setp(_clear(), _clear() + _sealer.chunkSize);
+	return _target.sputn(reinterpret_cast<const char*>(_cypher()), m) == m;
+    }
+};
+
+/*
+ * ChunkedOpenerBuf. std::istream side std::streambuf reading a ChunkedSealer blob, or a
+ * ChunkedAuthEncAdDataSealer stream, from another std::streambuf, one chunk at a time. A chunk that
+ * doesn't verify throws VerificationError out of underflow, which the std::istream turns into
+ * badbit unless badbit is in its exceptions() mask.
+ */
+template <Operation O, std::size_t S = OperationTraits<O>::NonceDefaultSequentialSize>
+class ChunkedOpenerBuf : public std::streambuf {
+public:
+    typedef typename Chunked::Types<O, S>::OpenerType		OpenerType;
+    typedef typename OpenerType::SecretKeyBaseType		SecretKeyBaseType;
+
+    ChunkedOpenerBuf(const SecretKeyBaseType& sk_, std::streambuf& source_, std::size_t maximumChunkSize_ = Chunked::MaximumChunkSize)
+	: _opener	{ sk_, nullptr, 1, maximumChunkSize_ }
+	, _source	{ source_ }
+	, _chunkSize	{ 0 }
+	, _chunks	{ 0 }
+	, _last		{ false }
+    {}
+    ChunkedOpenerBuf(const ChunkedOpenerBuf&) = delete;
+    ChunkedOpenerBuf(ChunkedOpenerBuf&&) = delete;
+
+    ChunkedOpenerBuf& operator = (const ChunkedOpenerBuf&) = delete;
+    ChunkedOpenerBuf& operator = (ChunkedOpenerBuf&&) = delete;
+
+protected:
+    int_type underflow() override
+    {
+	if(_chunks == 0)
+	{
+	    unsigned char header[OpenerType::HeaderSize];
+	    const std::streamsize n { _source.sgetn(reinterpret_cast<char*>(header), OpenerType::HeaderSize) };
+	    const std::size_t chunkSize { _opener.header(header, static_cast<std::size_t>(std::max<std::streamsize>(n, 0))) };
+	    std::unique_ptr<unsigned char[], Memory::Free> buffer { new(Memory::Allocate) unsigned char[2 * chunkSize + OpenerType::Overhead] };
+	    _buffer.swap(buffer);
+	    _chunkSize= chunkSize;
+	}
+	while(!_last)
+	{
+	    unsigned char* const cypher { _buffer.get() + _chunkSize };
+	    const std::streamsize sealed { static_cast<std::streamsize>(_chunkSize + OpenerType::Overhead) };
+	    const std::streamsize n { std::max<std::streamsize>(_source.sgetn(reinterpret_cast<char*>(cypher), sealed), 0) };
+	    _last= n < sealed || traits_type::eq_int_type(_source.sgetc(), traits_type::eof());
+	    ::sodium_memzero(_buffer.get(), _chunkSize);
+	    const std::size_t m { _opener.chunks(_chunks++, cypher, static_cast<std::size_t>(n), _buffer.get(), _last) };
+	    char* const clear { reinterpret_cast<char*>(_buffer.get()) };
+	    setg(clear, clear, clear + m);
+	    if(m > 0)
+		return traits_type::to_int_type(*gptr());
+	}
+	return traits_type::eof();
+    }
+
+private:
+    OpenerType						_opener;
+    std::streambuf&					_source;
+    std::size_t						_chunkSize;
+    std::uint64_t					_chunks;
+    bool						_last;
+    std::unique_ptr<unsigned char[], Memory::Free>	_buffer;
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOSTREAMBUF_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -0,0 +1,98 @@
+/*
+** CryptoThreadPool.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CHLORIDE_CRYPTOTHREADPOOL_H_
+#define CHLORIDE_CRYPTOTHREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CryptoBase.h"
+
+namespace Crypto {
+/*
+ * ThreadPool. Work-stealing pool for parallel loops: the range of a loop is cut into grains which
+ * are dealt out over the participants (the workers and the calling thread), idle participants
+ * steal grains from the back of the others' queues. One loop runs at a time, the first exception
+ * thrown by the loop body is rethrown in the calling thread once every grain has finished.
+ */
+class ThreadPool {
+public:
+    typedef std::function<void (std::size_t, std::size_t)>	RangeFunction;
+
+    explicit ThreadPool(std::size_t threads_ = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ~ThreadPool() noexcept;
+
+    ThreadPool& operator = (const ThreadPool&) = delete;
+    ThreadPool& operator = (ThreadPool&&) = delete;
+
+    /*
+     * Calls f_(begin, end) for consecutive ranges of grain_ indices covering [0, n_).
+     */
+    void operator () (std::size_t n_, std::size_t grain_, const RangeFunction& f_);
+
+    std::size_t threads() const noexcept			{ return _workers.size() + 1; }
+
+private:
+    typedef std::pair<std::size_t, std::size_t>		Range;
+
+    struct Queue {
+	std::mutex					mutex;
+	std::deque<Range>				ranges;
+    };
+
+    std::vector<std::thread>				_workers;
+    std::unique_ptr<Queue[]>				_queues;
+    std::mutex						_loop;
+    std::mutex						_mutex;
+    std::condition_variable				_start;
+    std::condition_variable				_done;
+    const RangeFunction*				_function;
+    std::size_t						_generation;
+    std::size_t						_active;
+    std::atomic<std::size_t>				_pending;
+    std::exception_ptr					_exception;
+    bool						_stop;
+
+    void _work(std::size_t index_) noexcept;
+    void _run(std::size_t index_, const RangeFunction& f_) noexcept;
+    bool _take(std::size_t index_, Range& r_) noexcept;
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOTHREADPOOL_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
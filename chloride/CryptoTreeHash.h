@@ -0,0 +1,105 @@
+/*
+** CryptoTreeHash.h
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHLORIDE_CRYPTOTREEHASH_H_
+#define CHLORIDE_CRYPTOTREEHASH_H_
+
+#include "CryptoHash.h"
+#include "CryptoThreadPool.h"
+
+namespace Crypto {
+/*
+ * Tree hashing format. The input is cut into leaves of leaf size bytes, the last one may be shorter and
+ * an empty input has one empty leaf. Every leaf is hashed to a full size BLAKE2b node, then fanout
+ * nodes at a time are hashed into the next level up until at most fanout nodes are left, which are
+ * hashed into the root of the requested size. Every BLAKE2b call carries the personalization Magic,
+ * version, leaf size, fanout and root size, and the salt of the node index, level and root flag, so
+ * a TreeHash never equals a plain BLAKE2b hash nor one with other parameters.
+ */
+namespace TreeHashing {
+constexpr unsigned char		Magic[]		{ 'C', 'h', 'T' };
+constexpr unsigned char		Version		{ 1 };
+constexpr std::size_t		DefaultLeafSize	{ 0x10000 };
+constexpr std::size_t		DefaultFanout	{ 16 };
+constexpr std::size_t		MaximumLeafSize	{ 0xFFFFFFFF };
+
+// Hash n_ bytes at p_ into oN_ bytes at o_, keyed when kN_ > 0, the leaves and levels in parallel on pool_ when given.
+void hash(unsigned char* o_, std::size_t oN_, const unsigned char* p_, std::size_t n_, const unsigned char* k_, std::size_t kN_,
+	  ThreadPool* pool_, std::size_t leafSize_, std::size_t fanout_);
+} // namespace TreeHashing
+
+/*
+ * TreeHash. Tree mode BLAKE2b of a memory range, a digest type of its own that only compares to other
+ * TreeHashes: the same input and parameters hash the same with or without a ThreadPool.
+ */
+template <std::size_t S = OperationTraits<Operation::GenericHashBlake2b>::HashSize> class TreeHash: private HashBase<S> {
+public:
+    const static Operation				Oper			{ Operation::GenericHashBlake2b };
+    constexpr static std::size_t			Size			{ S };
+    constexpr static std::size_t			MinimumSecretKeySize	{ OperationTraits<Oper>::MinimumSecretKeySize };
+    constexpr static std::size_t			MaximumSecretKeySize	{ OperationTraits<Oper>::SecretKeySize };
+
+    static_assert(OperationTraits<Oper>::MinimumHashSize <= Size && Size <= OperationTraits<Oper>::HashSize,
+		  "Illegally sized TreeHash type!");
+
+    TreeHash() noexcept = default;
+    explicit TreeHash(const unsigned char* raw_) noexcept
+	: HashBase<Size>(raw_)
+    {}
+    TreeHash(const unsigned char* p_, std::size_t n_, ThreadPool* pool_ = nullptr,
+	     std::size_t leafSize_ = TreeHashing::DefaultLeafSize, std::size_t fanout_ = TreeHashing::DefaultFanout)
+    {
+	TreeHashing::hash(HashBase<Size>::begin(), Size, p_, n_, nullptr, 0, pool_, leafSize_, fanout_);
+    }
+    TreeHash(const std::string& s_, ThreadPool* pool_ = nullptr,
+	     std::size_t leafSize_ = TreeHashing::DefaultLeafSize, std::size_t fanout_ = TreeHashing::DefaultFanout)
+	: TreeHash(reinterpret_cast<const unsigned char*>(&s_[0]), s_.length(), pool_, leafSize_, fanout_)
+    {}
+    template <std::size_t KS, typename std::enable_if<   MinimumSecretKeySize <= KS
+						      && KS <= MaximumSecretKeySize>::type* = nullptr>
+    TreeHash(const SecretKeyBase<KS>& k_, const unsigned char* p_, std::size_t n_, ThreadPool* pool_ = nullptr,
+	     std::size_t leafSize_ = TreeHashing::DefaultLeafSize, std::size_t fanout_ = TreeHashing::DefaultFanout)
+    {
+	TreeHashing::hash(HashBase<Size>::begin(), Size, p_, n_, k_.begin(), KS, pool_, leafSize_, fanout_);
+    }
+    template <std::size_t KS, typename std::enable_if<   MinimumSecretKeySize <= KS
+						      && KS <= MaximumSecretKeySize>::type* = nullptr>
+    TreeHash(const SecretKeyBase<KS>& k_, const std::string& s_, ThreadPool* pool_ = nullptr,
+	     std::size_t leafSize_ = TreeHashing::DefaultLeafSize, std::size_t fanout_ = TreeHashing::DefaultFanout)
+	: TreeHash(k_, reinterpret_cast<const unsigned char*>(&s_[0]), s_.length(), pool_, leafSize_, fanout_)
+    {}
+
+    using HashBase<Size>::begin;
+    using HashBase<Size>::end;
+    using HashBase<Size>::clear;
+
+    bool operator == (const TreeHash& h_) const noexcept	{ return HashBase<Size>::operator==(h_); }
+    bool operator != (const TreeHash& h_) const noexcept	{ return HashBase<Size>::operator!=(h_); }
+};
+
+} // namespace Crypto
+
+#endif /* CHLORIDE_CRYPTOTREEHASH_H_ */
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -0,0 +1,119 @@
+/*
+** CryptoAuthEncAdDataEngine.cpp
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#include "chloride/CryptoAuthEncAdDataEngine.h"
+
+#include <chrono>
+
+namespace Crypto {
+namespace {
+
+constexpr unsigned char		Aes256GcmId		{ 1 };
+constexpr unsigned char		Chacha20Poly1305IetfId	{ 2 };
+
+// Seal and open MessageSize bytes Rounds times, return the best of three in nanoseconds.
+template <Operation O> std::chrono::nanoseconds::rep time()
+{
+    constexpr std::size_t MessageSize { 0x1000 };
+    constexpr std::size_t Rounds { 16 };
+    const SecretKey<O> key { Tag::Generate };
+    Nonce<O> sealNonce { Tag::GenerateConstant };
+    Nonce<O> openNonce { sealNonce };
+    AuthEncAdDataSealer<O> seal { key, sealNonce };
+    AuthEncAdDataOpener<O> open { key, openNonce };
+    std::unique_ptr<unsigned char[], Memory::Free> buffer { new(Memory::Allocate) unsigned char[2 * MessageSize + seal.Overhead] };
+    unsigned char* const clear { buffer.get() };
+    unsigned char* const cypher { clear + MessageSize };
+    ::randombytes_buf(clear, MessageSize);
+    std::chrono::nanoseconds::rep best { 0 };
+    for(std::size_t i { 0 }; i != 3; ++i)
+    {
+	const auto start { std::chrono::steady_clock::now() };
+	for(std::size_t j { 0 }; j != Rounds; ++j)
+	{
+	    seal(clear, MessageSize, cypher, MessageSize + seal.Overhead);
+	    open(cypher, MessageSize + seal.Overhead, clear, MessageSize);
+	}
+	const auto elapsed { std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() };
+	if(i == 0 || elapsed < best)
+	    best= elapsed;
+    }
+    return best;
+}
+
+} // namespace
+
+Operation AuthEncAdDataEngine::fastest()
+{
+    static const Operation result { measure() };
+    return result;
+}
+
+Operation AuthEncAdDataEngine::measure()
+{
+    if(!available(Operation::AuthEncAdDataAes256Gcm))
+	return Operation::AuthEncAdDataChacha20Poly1305Ietf;
+    return time<Operation::AuthEncAdDataAes256Gcm>() < time<Operation::AuthEncAdDataChacha20Poly1305Ietf>()
+	? Operation::AuthEncAdDataAes256Gcm : Operation::AuthEncAdDataChacha20Poly1305Ietf;
+}
+
+bool AuthEncAdDataEngine::available(Operation oper_) noexcept
+{
+    switch(oper_) {
+    case Operation::AuthEncAdDataAes256Gcm:
+	return Operation_AuthEncAdDataAes256Gcm_Available();
+    case Operation::AuthEncAdDataChacha20Poly1305Ietf:
+	return true;
+    default:
+	return false;
+    }
+}
+
+unsigned char AuthEncAdDataEngine::id(Operation oper_)
+{
+    switch(oper_) {
+    case Operation::AuthEncAdDataAes256Gcm:
+	return Aes256GcmId;
+    case Operation::AuthEncAdDataChacha20Poly1305Ietf:
+	return Chacha20Poly1305IetfId;
+    default:
+	throw Exception(Exception::FormatMsg);
+    }
+}
+
+Operation AuthEncAdDataEngine::oper(unsigned char id_)
+{
+    switch(id_) {
+    case Aes256GcmId:
+	return Operation::AuthEncAdDataAes256Gcm;
+    case Chacha20Poly1305IetfId:
+	return Operation::AuthEncAdDataChacha20Poly1305Ietf;
+    default:
+	throw Exception(Exception::FormatMsg);
+    }
+}
+
+} // namespace Crypto
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
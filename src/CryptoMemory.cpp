@@ -0,0 +1,158 @@
+/*
+** CryptoMemory.cpp
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#include "chloride/CryptoMemory.h"
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CHLORIDE_XOR_X86	1
+#endif
+
+namespace Crypto {
+namespace Memory {
+namespace {
+
+void xorWords(unsigned char* p_, const unsigned char* q_, std::size_t n_) noexcept
+{
+    for(; n_ >= sizeof(std::uint64_t); p_+= sizeof(std::uint64_t), q_+= sizeof(std::uint64_t), n_-= sizeof(std::uint64_t))
+    {
+	std::uint64_t p, q;
+	std::memcpy(&p, p_, sizeof(p));
+	std::memcpy(&q, q_, sizeof(q));
+	p^= q;
+	std::memcpy(p_, &p, sizeof(p));
+    }
+    for(; n_ > 0; --n_)
+	*p_++^= *q_++;
+}
+
+#ifdef CHLORIDE_XOR_X86
+__attribute__((target("sse2"))) void xorSse2(unsigned char* p_, const unsigned char* q_, std::size_t n_) noexcept
+{
+    for(; n_ >= sizeof(__m128i); p_+= sizeof(__m128i), q_+= sizeof(__m128i), n_-= sizeof(__m128i))
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(p_),
+			 _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_)),
+				       _mm_loadu_si128(reinterpret_cast<const __m128i*>(q_))));
+    xorWords(p_, q_, n_);
+}
+
+__attribute__((target("avx2"))) void xorAvx2(unsigned char* p_, const unsigned char* q_, std::size_t n_) noexcept
+{
+    for(; n_ >= sizeof(__m256i); p_+= sizeof(__m256i), q_+= sizeof(__m256i), n_-= sizeof(__m256i))
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(p_),
+			    _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_)),
+					     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q_))));
+    xorWords(p_, q_, n_);
+}
+#endif
+
+struct XorKernel {
+    void					(*function)(unsigned char*, const unsigned char*, std::size_t) noexcept;
+    const char*					name;
+};
+
+XorKernel selectXorKernel() noexcept
+{
+#ifdef CHLORIDE_XOR_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+	return XorKernel { xorAvx2, "avx2" };
+    if(__builtin_cpu_supports("sse2"))
+	return XorKernel { xorSse2, "sse2" };
+#endif
+    return XorKernel { xorWords, "64 bit words" };
+}
+
+const XorKernel& xorKernelSelected() noexcept
+{
+    static const XorKernel kernel { selectXorKernel() };
+    return kernel;
+}
+
+} // namespace
+
+Pool::Pool(std::size_t slotSize_, std::size_t slotsPerBlock_)
+    : _slotSize		{ std::max(((slotSize_ + Alignment - 1) >> AlignmentShift) << AlignmentShift, Alignment) }
+    , _slotsPerBlock	{ std::max<std::size_t>(slotsPerBlock_, 1) }
+{
+    if(_slotSize < slotSize_ || _slotsPerBlock > SIZE_MAX / _slotSize)
+	throw Exception(Exception::SizeMsg);
+}
+
+unsigned char* Pool::allocate()
+{
+    std::lock_guard<std::mutex> lock { _mutex };
+    if(_free.empty())
+    {
+	std::unique_ptr<unsigned char[], Free> block { new(Allocate) unsigned char[_slotSize * _slotsPerBlock] };
+	_free.reserve((_blocks.size() + 1) * _slotsPerBlock);
+	_blocks.reserve(_blocks.size() + 1);
+	for(std::size_t i { _slotsPerBlock }; i-- > 0;)
+	    _free.push_back(block.get() + i * _slotSize);
+	_blocks.push_back(std::move(block));
+    }
+    unsigned char* slot { _free.back() };
+    _free.pop_back();
+    return slot;
+}
+
+void Pool::release(unsigned char* slot_) noexcept
+{
+    if(slot_ == nullptr)
+	return;
+    ::sodium_memzero(slot_, _slotSize);
+    std::lock_guard<std::mutex> lock { _mutex };
+    _free.push_back(slot_);	// Can't throw, capacity for every slot was reserved when its block was allocated.
+}
+
+std::size_t Pool::capacity()
+{
+    std::lock_guard<std::mutex> lock { _mutex };
+    return _blocks.size() * _slotsPerBlock;
+}
+
+std::size_t Pool::available()
+{
+    std::lock_guard<std::mutex> lock { _mutex };
+    return _free.size();
+}
+
+void xorBytes(unsigned char* p_, const unsigned char* q_, std::size_t n_) noexcept
+{
+    xorKernelSelected().function(p_, q_, n_);
+}
+
+const char* xorKernel() noexcept
+{
+    return xorKernelSelected().name;
+}
+
+} // namespace Memory
+} // namespace Crypto
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
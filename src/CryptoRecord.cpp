@@ -0,0 +1,77 @@
+/*
+** CryptoRecord.cpp
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#include "chloride/CryptoRecord.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace Crypto {
+namespace Record {
+
+void write(int fd_, ::iovec* iov_, std::size_t n_)
+{
+    while(n_ != 0)
+    {
+	const ::ssize_t written { ::writev(fd_, iov_, static_cast<int>(n_)) };
+	if(written < 0)
+	{
+	    if(errno == EINTR)
+		continue;
+	    throw std::system_error(errno, std::generic_category());
+	}
+	// Skip what was written, a partially written iovec goes out with the next writev.
+	std::size_t left { static_cast<std::size_t>(written) };
+	while(n_ != 0 && left >= iov_->iov_len)
+	{
+	    left-= iov_->iov_len;
+	    ++iov_;
+	    --n_;
+	}
+	if(n_ != 0)
+	{
+	    iov_->iov_base= static_cast<unsigned char*>(iov_->iov_base) + left;
+	    iov_->iov_len-= left;
+	}
+    }
+}
+
+std::size_t read(int fd_, unsigned char* p_, std::size_t n_)
+{
+    for(;;)
+    {
+	const ::ssize_t result { ::read(fd_, p_, n_) };
+	if(result >= 0)
+	    return static_cast<std::size_t>(result);
+	if(errno != EINTR)
+	    throw std::system_error(errno, std::generic_category());
+    }
+}
+
+} // namespace Record
+} // namespace Crypto
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
@@ -0,0 +1,174 @@
+/*
+** CryptoThreadPool.cpp
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#include "chloride/CryptoThreadPool.h"
+
+#include <algorithm>
+
+namespace Crypto {
+
+ThreadPool::ThreadPool(std::size_t threads_)
+    : _queues		{ new Queue[std::max<std::size_t>(threads_, 1)] }
+    , _function		{ nullptr }
+    , _generation	{ 0 }
+    , _active		{ 0 }
+    , _pending		{ 0 }
+    , _stop		{ false }
+{
+    try {
+	for(std::size_t i { 1 }; i < threads_; ++i)
+	    _workers.emplace_back(&ThreadPool::_work, this, i);
+    }
+    catch(...)
+    {
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    _stop= true;
+	}
+	_start.notify_all();
+	for(auto& w : _workers)
+	    w.join();
+	throw;
+    }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    {
+	std::lock_guard<std::mutex> lock { _mutex };
+	_stop= true;
+    }
+    _start.notify_all();
+    for(auto& w : _workers)
+	w.join();
+    _workers.clear();
+}
+
+void ThreadPool::operator () (std::size_t n_, std::size_t grain_, const RangeFunction& f_)
+{
+    if(n_ == 0)
+	return;
+    const std::size_t grain { std::max<std::size_t>(grain_, 1) };
+    std::lock_guard<std::mutex> loop { _loop };
+    std::size_t ranges { 0 };
+    for(std::size_t begin { 0 }; begin < n_; begin+= grain, ++ranges)
+    {
+	Queue& queue { _queues[ranges % threads()] };
+	std::lock_guard<std::mutex> lock { queue.mutex };
+	queue.ranges.emplace_back(begin, std::min(begin + grain, n_));
+    }
+    std::exception_ptr exception;
+    {
+	std::unique_lock<std::mutex> lock { _mutex };
+	_pending.store(ranges);
+	_exception= nullptr;
+	_function= &f_;
+	++_generation;
+	++_active;
+	lock.unlock();
+	_start.notify_all();
+	_run(0, f_);
+	lock.lock();
+	--_active;
+	_done.wait(lock, [this]() { return _pending.load() == 0 && _active == 0; });
+	_function= nullptr;
+	std::swap(exception, _exception);
+    }
+    if(exception)
+	std::rethrow_exception(exception);
+}
+
+void ThreadPool::_work(std::size_t index_) noexcept
+{
+    std::unique_lock<std::mutex> lock { _mutex };
+    std::size_t generation { _generation };
+    for(;;)
+    {
+	_start.wait(lock, [this, generation]() { return _stop || _generation != generation; });
+	if(_stop)
+	    return;
+	generation= _generation;
+	const RangeFunction* function { _function };
+	if(function == nullptr)
+	    continue;
+	++_active;
+	lock.unlock();
+	_run(index_, *function);
+	lock.lock();
+	if(--_active == 0)
+	    _done.notify_all();
+    }
+}
+
+void ThreadPool::_run(std::size_t index_, const RangeFunction& f_) noexcept
+{
+    Range range;
+    while(_take(index_, range))
+    {
+	try {
+	    f_(range.first, range.second);
+	}
+	catch(...)
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    if(!_exception)
+		_exception= std::current_exception();
+	}
+	if(_pending.fetch_sub(1) == 1)
+	{
+	    std::lock_guard<std::mutex> lock { _mutex };
+	    _done.notify_all();
+	}
+    }
+}
+
+bool ThreadPool::_take(std::size_t index_, Range& r_) noexcept
+{
+    {
+	Queue& own { _queues[index_] };
+	std::lock_guard<std::mutex> lock { own.mutex };
+	if(!own.ranges.empty())
+	{
+	    r_= own.ranges.front();
+	    own.ranges.pop_front();
+	    return true;
+	}
+    }
+    for(std::size_t i { 1 }; i < threads(); ++i)
+    {
+	Queue& other { _queues[(index_ + i) % threads()] };
+	std::lock_guard<std::mutex> lock { other.mutex };
+	if(!other.ranges.empty())
+	{
+	    r_= other.ranges.back();
+	    other.ranges.pop_back();
+	    return true;
+	}
+    }
+    return false;
+}
+
+} // namespace Crypto
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */
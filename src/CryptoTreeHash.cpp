@@ -0,0 +1,114 @@
+/*
+** CryptoTreeHash.cpp
+**
+**  Created on: Oct 17, 2026
+**      Author: gv
+**
+** This file is part of libchloride.
+** Copyright (C) 2015 Guy Vreuls
+**
+** Libchloride is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 2.1 of
+** the License, or (at your option) any later version.
+**
+** Libchloride is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with libchloride.  If not, see
+** <http://www.gnu.org/licenses/>.
+*/
+
+#include "chloride/CryptoTreeHash.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace Crypto {
+namespace TreeHashing {
+namespace {
+
+constexpr std::size_t		NodeSize	{ crypto_generichash_blake2b_BYTES_MAX };
+// Leaves are big enough to hand out one at a time, a node level takes this many parents per grain.
+constexpr std::size_t		NodeGrain	{ 64 };
+
+void store(unsigned char* p_, std::uint64_t v_, std::size_t n_) noexcept
+{
+    for(std::size_t i { 0 }; i != n_; ++i)
+	p_[i]= static_cast<unsigned char>(v_ >> (8 * i));
+}
+
+struct Node {
+    const unsigned char*				key;
+    std::size_t						keySize;
+    unsigned char					personal[crypto_generichash_blake2b_PERSONALBYTES];
+
+    void operator () (unsigned char* o_, std::size_t oN_, const unsigned char* p_, std::size_t n_, std::uint64_t index_,
+		      unsigned char level_, bool root_) const noexcept
+    {
+	unsigned char salt[crypto_generichash_blake2b_SALTBYTES] {};
+	store(salt, index_, 8);
+	salt[8]= level_;
+	salt[9]= root_ ? 1 : 0;
+	::crypto_generichash_blake2b_salt_personal(o_, oN_, p_, n_, key, keySize, salt, personal);
+    }
+};
+
+void run(ThreadPool* pool_, std::size_t n_, std::size_t grain_, const ThreadPool::RangeFunction& f_)
+{
+    if(pool_ && n_ > grain_)
+	(*pool_)(n_, grain_, f_);
+    else
+	f_(0, n_);
+}
+
+} // namespace
+
+void hash(unsigned char* o_, std::size_t oN_, const unsigned char* p_, std::size_t n_, const unsigned char* k_, std::size_t kN_,
+	  ThreadPool* pool_, std::size_t leafSize_, std::size_t fanout_)
+{
+    if(leafSize_ == 0 || leafSize_ > MaximumLeafSize || fanout_ < 2 || fanout_ > 0xFFFFFFFF)
+	throw Exception(Exception::SizeMsg);
+    Node node { k_, kN_, {} };
+    unsigned char* personal { std::copy(std::begin(Magic), std::end(Magic), node.personal) };
+    *personal++= Version;
+    store(personal, leafSize_, 4);
+    store(personal + 4, fanout_, 4);
+    store(personal + 8, oN_, 4);
+
+    std::size_t count { n_ == 0 ? 1 : (n_ - 1) / leafSize_ + 1 };
+    std::vector<unsigned char> nodes(count * NodeSize);
+    run(pool_, count, 1, [&](std::size_t b_, std::size_t e_) {
+	for(std::size_t i { b_ }; i != e_; ++i)
+	{
+	    const std::size_t offset { i * leafSize_ };
+	    node(&nodes[i * NodeSize], NodeSize, p_ + offset, std::min(leafSize_, n_ - std::min(offset, n_)), i, 0, false);
+	}
+    });
+    // Each level of parents replaces the level of children below it.
+    for(unsigned char level { 1 }; count > fanout_; ++level)
+    {
+	const std::size_t parents { (count - 1) / fanout_ + 1 };
+	std::vector<unsigned char> up(parents * NodeSize);
+	run(pool_, parents, NodeGrain, [&](std::size_t b_, std::size_t e_) {
+	    for(std::size_t i { b_ }; i != e_; ++i)
+	    {
+		const std::size_t children { std::min(fanout_, count - i * fanout_) };
+		node(&up[i * NodeSize], NodeSize, &nodes[i * fanout_ * NodeSize], children * NodeSize, i, level, false);
+	    }
+	});
+	nodes.swap(up);
+	count= parents;
+    }
+    node(o_, oN_, nodes.data(), count * NodeSize, 0, 0xFF, true);
+}
+
+} // namespace TreeHashing
+} // namespace Crypto
+
+/* vi:set nojs noet ts=8 sts=4 sw=4 cindent: */